@@ -0,0 +1,179 @@
+#pragma once
+
+#include "GameState.hpp"
+#include "Generators.hpp"
+#include "Deadline.hpp"
+#include "BucketQueue.hpp"
+#include "NodePool.hpp"
+#include "Solution.hpp"
+#include "ClosedList.hpp"
+#include <vector>
+#include <iostream>
+#include <limits>
+#include <algorithm>
+
+// Anytime repairing A* (ARA*, Likhachev et al. 2003) : weighted A* with a weight lowered by STEP after
+// each solution, down to 1 where the solution is the shortest. Each search only reopens the states whose
+// depth got shorter since they were expanded, the rest of the previous searches is kept. Every solution
+// is reported on the error output as it is found, with its bound, away from the moves and statistics.
+class AnytimeAStar {
+  public:
+    static constexpr double DEFAULT_WEIGHT = 3; // first weight when none is given
+    static constexpr double STEP = 0.5;
+
+    AnytimeAStar(const GameState& initial, const GameState& solution, const heuristic_t& heuristic):
+        _initial(initial),
+        _solution(solution),
+        _heuristic(heuristic),
+        _weight(heuristic.weight > 1 ? heuristic.weight : DEFAULT_WEIGHT),
+        _iteration(1),
+        _goal(NOT_FOUND),
+        _records(heuristic.memory),
+        _total_states(0),
+        _max_ressource(0)
+    {}
+
+    Solution solve() {
+        GameState start(_initial);
+        Solution best;
+        size_t length = NOT_FOUND; // of best
+
+        start.setHeuristicScore(_heuristic.full(start, _solution));
+        GameState::weights(_weight, _gWeight, _hWeight);
+        store(std::move(start), PathTree::ROOT, GameState::RIGHT);
+        if (_initial == _solution) // goals are only seen when generated
+            _goal = 0;
+        while (true) {
+            improvePath();
+            if (_goal == NOT_FOUND)
+                return best;
+            if (_goal < length) {
+                best = _paths.solution(_records.at(_solution.key()).path);
+                length = best.size();
+                std::cerr << "Solution of " << best.size() << " moves with weight " << _weight;
+                if (_weight > 1)
+                    std::cerr << " (at most " << _weight << " times the shortest), ";
+                else
+                    std::cerr << " (the shortest), ";
+                std::cerr << _total_states << " states" << std::endl;
+            }
+            if (_weight <= 1 || (_open.empty() && _inconsistent.empty()))
+                return best;
+            _weight = std::max(1.0, _weight - STEP);
+            GameState::weights(_weight, _gWeight, _hWeight);
+            _iteration++;
+            reorder();
+        }
+    }
+
+    size_t totalStates() const {
+        return _total_states;
+    }
+
+    size_t maxRessource() const {
+        return _max_ressource;
+    }
+
+  private:
+    static const size_t NOT_FOUND = std::numeric_limits<size_t>::max();
+
+    struct Node {
+        GameState   state;
+        uint32_t    path;
+    };
+
+    struct Record {
+        size_t      depth; // shortest found
+        uint32_t    path;
+        uint32_t    closed; // search that expanded the state, 0 if none
+    };
+
+    size_t priority(const GameState& state) const {
+        return state.getDepth() * _gWeight + state.getHeuristicScore() * _hWeight;
+    }
+
+    // expands states until none can lead to a solution shorter than the one found, for the current weight
+    void improvePath() {
+        while (!_open.empty() && (_goal == NOT_FOUND || _goal * _gWeight > _open.topF())) {
+            uint32_t handle = _open.pop();
+            Node& node = _nodes[handle];
+            GameState& current = node.state;
+            Record& record = _records.at(current.key());
+
+            if (record.depth < current.getDepth() || record.closed == _iteration) { // outdated or already expanded
+                _nodes.release(handle);
+                continue;
+            }
+            record.closed = _iteration;
+            for (auto& move : current.directions) {
+                if (current.isRedundant(move.second))
+                    continue ;
+                GameState::Point neighbor = current.neighbor(move.first);
+                if (!neighbor.in_bounds(current.size()))
+                    continue;
+                GameState next(current);
+                next.setHeuristicScore(next.getHeuristicScore() + _heuristic.update(next, _solution, neighbor));
+                next.swap(neighbor);
+                Record *already_visited = _records.find(next.key());
+                if (already_visited && already_visited->depth <= next.getDepth())
+                    continue;
+                next.setRedondant(move.second * -1);
+                if (next == _solution)
+                    _goal = next.getDepth();
+                store(std::move(next), node.path, move.first);
+            }
+            _nodes.release(handle);
+            if (_open.size() + _records.size() > _max_ressource)
+                _max_ressource = _open.size() + _records.size();
+            _total_states++;
+            Deadline::check(_total_states);
+        }
+    }
+
+    // records a state reached by a shorter path, it waits for the next search if it was already expanded by this one
+    void store(GameState&& state, uint32_t parent, GameState::Direction move) {
+        uint32_t path = _paths.add(parent, move);
+        Record& record = *_records.insert(state.key(), Record{0, 0, 0}).first;
+        bool expanded = record.closed == _iteration;
+
+        record.depth = state.getDepth();
+        record.path = path;
+        uint32_t handle = _nodes.store(Node{std::move(state), path});
+        if (expanded)
+            _inconsistent.push_back(handle);
+        else
+            _open.push(priority(_nodes[handle].state), _nodes[handle].state.getHeuristicScore(), handle);
+    }
+
+    // the priorities depend on the weight : the open list is rebuilt with the new one
+    void reorder() {
+        std::vector<uint32_t> handles(_inconsistent);
+
+        _inconsistent.clear();
+        while (!_open.empty())
+            handles.push_back(_open.pop());
+        for (uint32_t handle : handles) {
+            const GameState& state = _nodes[handle].state;
+            if (_records.at(state.key()).depth < state.getDepth())
+                _nodes.release(handle);
+            else
+                _open.push(priority(state), state.getHeuristicScore(), handle);
+        }
+    }
+
+    const GameState&                                    _initial;
+    const GameState&                                    _solution;
+    const heuristic_t&                                  _heuristic;
+    double                                              _weight;
+    size_t                                              _gWeight;
+    size_t                                              _hWeight;
+    uint32_t                                            _iteration;
+    size_t                                              _goal; // depth of the best solution found, NOT_FOUND if none
+    BucketQueue<uint32_t>                               _open;
+    std::vector<uint32_t>                               _inconsistent; // states reached by a shorter path after their expansion
+    NodePool<Node>                                      _nodes;
+    PathTree                                            _paths;
+    ClosedList<Record>                                  _records;
+    size_t                                              _total_states;
+    size_t                                              _max_ressource;
+};
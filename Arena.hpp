@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+// Append only storage in fixed size chunks : growing never moves or copies what is already stored,
+// so references stay valid, and elements are referred to by a 32 bits index.
+template <typename T, size_t CHUNK_BITS = 16>
+class Arena {
+  public:
+    static const size_t CHUNK = (size_t)1 << CHUNK_BITS;
+
+    Arena() : _size(0) {}
+
+    uint32_t push(T&& value) {
+        if ((_size & (CHUNK - 1)) == 0) {
+            _chunks.push_back(std::vector<T>());
+            _chunks.back().reserve(CHUNK);
+        }
+        _chunks.back().push_back(std::move(value));
+        return _size++;
+    }
+
+    uint32_t push(const T& value) {
+        return push(T(value));
+    }
+
+    T& operator[](uint32_t index) {
+        return _chunks[index >> CHUNK_BITS][index & (CHUNK - 1)];
+    }
+
+    const T& operator[](uint32_t index) const {
+        return _chunks[index >> CHUNK_BITS][index & (CHUNK - 1)];
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+  private:
+    std::vector<std::vector<T> >    _chunks;
+    size_t                          _size;
+};
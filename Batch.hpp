@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Generators.hpp"
+#include "Puzzle.hpp"
+#include "Deadline.hpp"
+#include <iostream>
+#include <sstream>
+#include <memory>
+#include <deque>
+#include <map>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <cmath>
+
+// Solves every puzzle of a file on a pool of threads, each puzzle on a single thread. The goals and the
+// heuristic tables are built once per size by the thread reading the file, before the first puzzle of that
+// size is handed to the workers, and are only read afterwards.
+class Batch {
+  public:
+    Batch(const heuristic_t& heuristic):
+        _heuristic(heuristic),
+        _workers(heuristic.threads),
+        _reading(true),
+        _next(0)
+    {
+        _heuristic.threads = 1;
+    }
+
+    // prints one line per puzzle, in the order of the file, as soon as the puzzles before it are solved :
+    // its number, then the number of moves, total states, max ressource and the moves (R, D, L, U),
+    // or "unsolvable", or "error" and the reason
+    void run() {
+        Generators gen;
+        std::unique_ptr<Generators::FileReader> input;
+        std::map<size_t, std::shared_ptr<const Data> > goals;
+        std::vector<std::thread> threads;
+        Job job;
+
+        if (_heuristic.batch == "-")
+            input.reset(new Generators::FileReader(STDIN_FILENO));
+        else
+            input.reset(new Generators::FileReader(_heuristic.batch));
+        if (!input->is_open())
+            throw Generators::ParsingException("Error opening \"" + _heuristic.batch + "\" : " + std::strerror(errno));
+        for (size_t i = 0; i < _workers; i++)
+            threads.emplace_back(&Batch::work, this);
+        try {
+            for (job.index = 0; gen.nextTable(*input, job.data); job.index++) {
+                size_t size = std::sqrt(job.data.size());
+                if (goals.find(size) == goals.end()) {
+                    Data goal = gen.generateSolution();
+                    _heuristic.loadTables(goal);
+                    goals[size] = std::make_shared<const Data>(goal);
+                }
+                job.goal = goals[size];
+                push(std::move(job));
+            }
+        } catch (Generators::ParsingException &e) {
+            finish(threads);
+            throw Generators::ParsingException("Puzzle " + std::to_string(job.index + 1) + " : " + e.what());
+        } catch (...) {
+            finish(threads);
+            throw;
+        }
+        finish(threads);
+    }
+
+  private:
+    struct Job {
+        size_t                          index;
+        Data                            data;
+        std::shared_ptr<const Data>     goal;
+    };
+
+    void push(Job&& job) {
+        std::unique_lock<std::mutex> lock(_lock);
+        _has_room.wait(lock, [this] { return _jobs.size() < 4 * _workers; }); // reads ahead of the workers, not the whole file
+        _jobs.push_back(std::move(job));
+        _has_jobs.notify_one();
+    }
+
+    bool pop(Job& job) {
+        std::unique_lock<std::mutex> lock(_lock);
+        _has_jobs.wait(lock, [this] { return !_jobs.empty() || !_reading; });
+        if (_jobs.empty())
+            return false;
+        job = std::move(_jobs.front());
+        _jobs.pop_front();
+        _has_room.notify_one();
+        return true;
+    }
+
+    // lets the workers solve what is left, then waits for them
+    void finish(std::vector<std::thread>& threads) {
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _reading = false;
+        }
+        _has_jobs.notify_all();
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    void work() {
+        Job job;
+
+        while (pop(job))
+            output(job.index, solve(job));
+    }
+
+    std::string solve(const Job& job) const {
+        std::ostringstream line;
+
+        line << job.index + 1;
+        try {
+            if (!GameState(job.data, std::sqrt(job.data.size())).isSolvable()) {
+                line << " unsolvable";
+                return line.str();
+            }
+            Puzzle puzzle(_heuristic, job.data, *job.goal);
+            Deadline::set(_heuristic.timeout);
+            Solution solution = puzzle.solve();
+            line << ' ' << solution.size() << ' ' << puzzle.totalStates() << ' ' << puzzle.maxRessource()
+                 << ' ' << solution.toString();
+        } catch (std::exception &e) {
+            line << " error " << e.what();
+        }
+        return line.str();
+    }
+
+    // keeps the lines of the puzzles solved early until all the puzzles before them are printed
+    void output(size_t index, const std::string& line) {
+        std::lock_guard<std::mutex> lock(_output_lock);
+
+        _results[index] = line;
+        if (_results.begin()->first != _next)
+            return;
+        for (auto result = _results.begin(); result != _results.end() && result->first == _next; ++result, _next++)
+            std::cout << result->second << '\n';
+        _results.erase(_results.begin(), _results.lower_bound(_next));
+        std::cout.flush();
+    }
+
+    heuristic_t                     _heuristic;
+    size_t                          _workers;
+    std::mutex                      _lock;
+    std::condition_variable         _has_jobs;
+    std::condition_variable         _has_room;
+    std::deque<Job>                 _jobs;
+    bool                            _reading; // false once the whole file has been read
+    std::mutex                      _output_lock;
+    std::map<size_t, std::string>   _results;
+    size_t                          _next; // number of lines printed
+};
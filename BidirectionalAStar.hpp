@@ -0,0 +1,153 @@
+#pragma once
+
+#include "GameState.hpp"
+#include "Generators.hpp"
+#include "Deadline.hpp"
+#include "BucketQueue.hpp"
+#include "NodePool.hpp"
+#include "Solution.hpp"
+#include "ClosedList.hpp"
+#include <limits>
+#include <algorithm>
+
+// Bidirectional A* meeting in the middle (MM, Holte et al. 2016) : one search goes from the initial state
+// to the solution and one from the solution back to the initial state, each with a heuristic towards its
+// own target. States are expanded by priority max(f, 2 * depth), which keeps both searches from going past
+// the middle, and each time a state is generated that the other search has reached, the sum of both depths
+// is a solution. The search stops when the best one is not above the lowest priority left, which proves it optimal.
+class BidirectionalAStar {
+  public:
+    BidirectionalAStar(const GameState& initial, const GameState& solution, const heuristic_t& heuristic):
+        _total_states(0),
+        _max_ressource(0),
+        _best(NOT_FOUND)
+    {
+        _sides[FORWARD].start = &initial;
+        _sides[FORWARD].target = &solution;
+        _sides[FORWARD].heuristic = heuristic;
+        _sides[BACKWARD].start = &solution;
+        _sides[BACKWARD].target = &initial;
+        _sides[BACKWARD].heuristic = heuristic.towardsAnyState();
+        for (Side& side : _sides)
+            side.visited = ClosedList<Record>(heuristic.memory / 2);
+    }
+
+    Solution solve() {
+        for (Side& side : _sides) {
+            GameState start(*side.start);
+            start.setHeuristicScore(side.heuristic.full(start, *side.target));
+            push(side, std::move(start), PathTree::ROOT, GameState::RIGHT);
+        }
+        if (*_sides[FORWARD].start == *_sides[BACKWARD].start)
+            return Solution();
+        while (!_sides[FORWARD].open.empty() && !_sides[BACKWARD].open.empty()) {
+            size_t forward = _sides[FORWARD].open.topF();
+            size_t backward = _sides[BACKWARD].open.topF();
+            if (_best <= std::min(forward, backward))
+                break;
+            expand(forward <= backward ? FORWARD : BACKWARD);
+        }
+        if (_best == NOT_FOUND)
+            return Solution();
+        return constructSolution();
+    }
+
+    size_t totalStates() const {
+        return _total_states;
+    }
+
+    size_t maxRessource() const {
+        return _max_ressource;
+    }
+
+  private:
+    static const size_t NOT_FOUND = std::numeric_limits<size_t>::max();
+    enum { FORWARD, BACKWARD };
+
+    struct Node {
+        GameState   state;
+        uint32_t    path;
+    };
+
+    struct Record {
+        size_t      depth;
+        uint32_t    path;
+    };
+
+    struct Side {
+        const GameState                                 *start;
+        const GameState                                 *target;
+        heuristic_t                                     heuristic;
+        BucketQueue<uint32_t>                           open; // by max(f, 2 * depth) then h
+        NodePool<Node>                                  nodes;
+        PathTree                                        paths;
+        ClosedList<Record>                              visited; // best depth of each generated state
+    };
+
+    static size_t priority(const GameState& state) {
+        return std::max(state.getDepth() + state.getHeuristicScore(), 2 * state.getDepth());
+    }
+
+    void push(Side& side, GameState&& state, uint32_t parent, GameState::Direction move) {
+        uint32_t path = side.paths.add(parent, move);
+        *side.visited.insert(state.key(), Record()).first = Record{state.getDepth(), path};
+        side.open.push(priority(state), state.getHeuristicScore(), side.nodes.store(Node{std::move(state), path}));
+    }
+
+    void expand(size_t direction) {
+        Side& side = _sides[direction];
+        Side& other = _sides[1 - direction];
+        uint32_t handle = side.open.pop();
+        Node& node = side.nodes[handle];
+        GameState& current = node.state;
+
+        if (side.visited.at(current.key()).depth < current.getDepth()) { // reached again by a shorter path since
+            side.nodes.release(handle);
+            return;
+        }
+        for (auto& move : current.directions) {
+            if (current.isRedundant(move.second))
+                continue ;
+            GameState::Point neighbor = current.neighbor(move.first);
+            if (!neighbor.in_bounds(current.size()))
+                continue;
+            GameState next(current);
+            next.setHeuristicScore(next.getHeuristicScore() + side.heuristic.update(next, *side.target, neighbor));
+            next.swap(neighbor);
+            Record *already_visited = side.visited.find(next.key());
+            if (already_visited && already_visited->depth <= next.getDepth())
+                continue;
+            next.setRedondant(move.second * -1);
+            Record *meeting = other.visited.find(next.key());
+            if (meeting && next.getDepth() + meeting->depth < _best) {
+                _best = next.getDepth() + meeting->depth;
+                _meeting[direction] = side.paths.size(); // path node push() is about to add
+                _meeting[1 - direction] = meeting->path;
+            }
+            push(side, std::move(next), node.path, move.first);
+        }
+        side.nodes.release(handle);
+        size_t ressource = _sides[FORWARD].open.size() + _sides[FORWARD].visited.size()
+                         + _sides[BACKWARD].open.size() + _sides[BACKWARD].visited.size();
+        if (ressource > _max_ressource)
+            _max_ressource = ressource;
+        _total_states++;
+        Deadline::check(_total_states);
+    }
+
+    // moves from the initial state to the meeting state, then the backward moves undone in reverse order
+    Solution constructSolution() const {
+        Solution solution = _sides[FORWARD].paths.solution(_meeting[FORWARD]);
+        Solution backward = _sides[BACKWARD].paths.solution(_meeting[BACKWARD]);
+
+        for (size_t i = backward.size(); i > 0; i--)
+            solution.push_back(GameState::opposite(backward[i - 1]));
+        return solution;
+    }
+
+    Side        _sides[2];
+    size_t      _total_states;
+    size_t      _max_ressource;
+    size_t      _best; // length of the best solution found so far
+    uint32_t    _meeting[2]; // path nodes of the best solution's meeting state on both sides
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <streambuf>
+#include <vector>
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+
+// Stream buffer writing to a file descriptor in blocks : nothing is written before the block is full or
+// the stream is flushed, whatever the number of lines. Used through an std::ostream, flushed when destroyed.
+class BlockWriter : public std::streambuf {
+  public:
+    static const size_t BLOCK = 1 << 16;
+
+    BlockWriter(int fd = STDOUT_FILENO) : _fd(fd), _block(BLOCK) {
+        setp(_block.data(), _block.data() + _block.size());
+    }
+
+    ~BlockWriter() {
+        sync();
+    }
+
+  protected:
+    int overflow(int c) override {
+        if (sync() != 0)
+            return EOF;
+        if (c != EOF) {
+            *pptr() = c;
+            pbump(1);
+        }
+        return c == EOF ? 0 : c;
+    }
+
+    int sync() override {
+        const char *data = pbase();
+
+        while (data < pptr()) {
+            ssize_t written = write(_fd, data, pptr() - data);
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written <= 0)
+                return -1;
+            data += written;
+        }
+        setp(_block.data(), _block.data() + _block.size());
+        return 0;
+    }
+
+  private:
+    int                 _fd;
+    std::vector<char>   _block;
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+// Fixed width packed array of cells, used for the tiles of a GameState and their reverse index.
+// A cell takes 4 bits up to 16 cells (a 4x4 board fits in a single uint64_t), 8 bits up to 256 cells
+// and 16 bits above. Boards of up to INLINE_WORDS words, up to 5x5, are stored inline so copying a state of
+// those sizes allocates nothing. Larger ones (6x6 takes 5 words) allocate their words on every copy : the
+// searches that keep states don't get far on them, and a wider buffer would grow the states of every size.
+// The packed words are the exact key of the board : two boards are equal only if all their cells are.
+class Board {
+  public:
+    static const size_t INLINE_WORDS = 4; // 25 cells of 8 bits
+
+    struct Hash {
+        size_t operator()(const Board& board) const {
+            return board.hash();
+        }
+    };
+
+    Board(size_t cells = 0) : _cells(cells) {
+        _shift = cells <= 16 ? 2 : cells <= 256 ? 3 : 4; // log2 of the cell width
+        _words = (cells + perWord() - 1) / perWord();
+        if (_words > INLINE_WORDS)
+            _heap = new uint64_t[_words];
+        std::memset(words(), 0, _words * sizeof(uint64_t));
+    }
+
+    Board(const Board& rhs) : _cells(rhs._cells), _words(rhs._words), _shift(rhs._shift) {
+        if (_words > INLINE_WORDS)
+            _heap = new uint64_t[_words];
+        std::memcpy(words(), rhs.words(), _words * sizeof(uint64_t));
+    }
+
+    Board(Board&& rhs) : _cells(rhs._cells), _words(rhs._words), _shift(rhs._shift) {
+        if (_words > INLINE_WORDS) {
+            _heap = rhs._heap;
+            rhs._words = 0;
+            rhs._cells = 0;
+        }
+        else
+            std::memcpy(_inline, rhs._inline, _words * sizeof(uint64_t));
+    }
+
+    ~Board() {
+        if (_words > INLINE_WORDS)
+            delete[] _heap;
+    }
+
+    Board& operator=(const Board& rhs) {
+        if (this != &rhs) {
+            Board tmp(rhs);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    Board& operator=(Board&& rhs) {
+        if (this == &rhs)
+            return *this;
+        if (_words > INLINE_WORDS)
+            delete[] _heap;
+        _cells = rhs._cells;
+        _words = rhs._words;
+        _shift = rhs._shift;
+        if (_words > INLINE_WORDS) {
+            _heap = rhs._heap;
+            rhs._words = 0;
+            rhs._cells = 0;
+        }
+        else
+            std::memcpy(_inline, rhs._inline, _words * sizeof(uint64_t));
+        return *this;
+    }
+
+    size_t get(size_t index) const {
+        return (words()[index >> (6 - _shift)] >> offset(index)) & cellMask();
+    }
+
+    void set(size_t index, size_t value) {
+        uint64_t& word = words()[index >> (6 - _shift)];
+        word = (word & ~(cellMask() << offset(index))) | ((uint64_t)value << offset(index));
+    }
+
+    size_t cells() const {
+        return _cells;
+    }
+
+    uint64_t hash() const { // murmur3 finalizer over the words, the key itself stays exact
+        return hash(words(), _words, _cells);
+    }
+
+    static uint64_t hash(const uint64_t *w, size_t count, size_t cells) { // of a board packed in count words
+        uint64_t h = cells;
+        for (size_t i = 0; i < count; i++) {
+            h ^= w[i];
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+        }
+        return h;
+    }
+
+    const uint64_t *packed() const { // the words of the key
+        return words();
+    }
+
+    size_t packedSize() const {
+        return _words;
+    }
+
+    friend bool operator==(const Board& lhs, const Board& rhs) {
+        return lhs._cells == rhs._cells
+            && std::memcmp(lhs.words(), rhs.words(), lhs._words * sizeof(uint64_t)) == 0;
+    }
+
+    friend bool operator!=(const Board& lhs, const Board& rhs) {
+        return !(lhs == rhs);
+    }
+
+  private:
+    size_t perWord() const {
+        return 64 >> _shift;
+    }
+
+    uint64_t cellMask() const {
+        return (1ULL << (1 << _shift)) - 1;
+    }
+
+    size_t offset(size_t index) const {
+        return (index & (perWord() - 1)) << _shift;
+    }
+
+    uint64_t *words() {
+        return _words > INLINE_WORDS ? _heap : _inline;
+    }
+
+    const uint64_t *words() const {
+        return _words > INLINE_WORDS ? _heap : _inline;
+    }
+
+    union {
+        uint64_t    _inline[INLINE_WORDS];
+        uint64_t    *_heap;
+    };
+    uint32_t        _cells;
+    uint16_t        _words;
+    uint8_t         _shift;
+};
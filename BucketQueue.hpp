@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// Priority queue for small integer priorities : one bucket per f, and inside it one bucket per h,
+// so that the lowest f comes first and, for the same f, the lowest h (the state closest to the solution).
+// Values inside a bucket come out last in first out. Push and pop are O(1) amortized, the cursors
+// only move back when a lower priority than the current minimum is pushed.
+template <typename T>
+class BucketQueue {
+  public:
+    BucketQueue() : _size(0), _minF(0) {}
+
+    void push(size_t f, size_t h, const T& value) {
+        if (f >= _levels.size())
+            _levels.resize(f + 1);
+        Level& level = _levels[f];
+        if (h >= level.buckets.size())
+            level.buckets.resize(h + 1);
+        level.buckets[h].push_back(value);
+        if (level.count++ == 0 || h < level.minH)
+            level.minH = h;
+        if (_size++ == 0 || f < _minF)
+            _minF = f;
+    }
+
+    const T& top() {
+        Level& level = seek();
+        return level.buckets[level.minH].back();
+    }
+
+    T pop() {
+        Level& level = seek();
+        T value = level.buckets[level.minH].back();
+        level.buckets[level.minH].pop_back();
+        level.count--;
+        _size--;
+        return value;
+    }
+
+    size_t topF() {
+        seek();
+        return _minF;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+  private:
+    struct Level {
+        Level() : count(0), minH(0) {}
+
+        std::vector<std::vector<T> >    buckets;
+        size_t                          count;
+        size_t                          minH;
+    };
+
+    // moves the cursors to the first non empty bucket, the queue must not be empty
+    Level& seek() {
+        while (_levels[_minF].count == 0)
+            _minF++;
+        Level& level = _levels[_minF];
+        while (level.buckets[level.minH].empty())
+            level.minH++;
+        return level;
+    }
+
+    std::vector<Level>  _levels;
+    size_t              _size;
+    size_t              _minF;
+};
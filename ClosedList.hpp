@@ -0,0 +1,154 @@
+#pragma once
+
+#include "Board.hpp"
+#include <memory>
+#include <utility>
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <cstdint>
+
+// Closed list of a search : the value (best depth, ...) of every board reached, in a flat open addressing
+// table. Each slot has a control byte (0 if empty, else 7 bits of the hash), then the packed words of the
+// board and its value, each in its own array, so that probing only reads the control bytes until a tag
+// matches, and a match is confirmed on the whole board. Removing a board shifts back the ones probed after it.
+// With a memory budget, the table takes all of it at the first insertion and never grows, a search that
+// needs more stops with an error. Without, it starts small and doubles when 7/8 full.
+// Values are plain structs, and pointers to them are only valid until the next insertion.
+template <typename Value>
+class ClosedList {
+  public:
+    ClosedList(size_t budget = 0) : _budget(budget), _words(0), _cells(0), _capacity(0), _size(0) {}
+
+    Value *find(const Board& key) {
+        if (_capacity == 0)
+            return nullptr;
+        uint64_t hash = key.hash();
+        uint8_t tag = tagOf(hash);
+
+        for (size_t slot = hash & (_capacity - 1); _control[slot] != EMPTY; slot = (slot + 1) & (_capacity - 1))
+            if (_control[slot] == tag && std::memcmp(&_keys[slot * _words], key.packed(), _words * sizeof(uint64_t)) == 0)
+                return &_values[slot];
+        return nullptr;
+    }
+
+    Value& at(const Board& key) {
+        Value *value = find(key);
+        if (!value)
+            throw std::out_of_range("Board not in the closed list");
+        return *value;
+    }
+
+    // adds the board with value if it is not in the list yet, returns its value and whether it was added
+    std::pair<Value*, bool> insert(const Board& key, const Value& value) {
+        if (_capacity == 0)
+            allocate(key);
+        else if ((_size + 1) * 8 > _capacity * 7)
+            grow();
+        uint64_t hash = key.hash();
+        uint8_t tag = tagOf(hash);
+        size_t slot = hash & (_capacity - 1);
+
+        for (; _control[slot] != EMPTY; slot = (slot + 1) & (_capacity - 1))
+            if (_control[slot] == tag && std::memcmp(&_keys[slot * _words], key.packed(), _words * sizeof(uint64_t)) == 0)
+                return std::make_pair(&_values[slot], false);
+        _control[slot] = tag;
+        std::memcpy(&_keys[slot * _words], key.packed(), _words * sizeof(uint64_t));
+        _values[slot] = value;
+        _size++;
+        return std::make_pair(&_values[slot], true);
+    }
+
+    void erase(const Board& key) {
+        Value *value = find(key);
+        if (!value)
+            return;
+        size_t hole = value - _values.get();
+
+        for (size_t slot = (hole + 1) & (_capacity - 1); _control[slot] != EMPTY; slot = (slot + 1) & (_capacity - 1)) {
+            size_t home = Board::hash(&_keys[slot * _words], _words, _cells) & (_capacity - 1);
+            if (((slot - home) & (_capacity - 1)) < ((slot - hole) & (_capacity - 1)))
+                continue; // its probe starts after the hole, it can't move back into it
+            _control[hole] = _control[slot];
+            std::memcpy(&_keys[hole * _words], &_keys[slot * _words], _words * sizeof(uint64_t));
+            _values[hole] = _values[slot];
+            hole = slot;
+        }
+        _control[hole] = EMPTY;
+        _size--;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    double loadFactor() const {
+        return _capacity ? (double)_size / _capacity : 0;
+    }
+
+  private:
+    static const uint8_t EMPTY = 0;
+    static const size_t INITIAL_CAPACITY = 1 << 10;
+
+    static uint8_t tagOf(uint64_t hash) { // high bits, the low ones pick the slot
+        return (hash >> 57) | 0x80;
+    }
+
+    size_t slotSize() const {
+        return 1 + _words * sizeof(uint64_t) + sizeof(Value);
+    }
+
+    // the keys and values are left uninitialized : only the pages of the slots used are touched
+    void reserve(size_t capacity) {
+        _capacity = capacity;
+        _control.reset(new uint8_t[capacity]());
+        _keys.reset(new uint64_t[capacity * _words]);
+        _values.reset(new Value[capacity]);
+    }
+
+    void allocate(const Board& key) {
+        size_t capacity = INITIAL_CAPACITY;
+
+        _words = key.packedSize();
+        _cells = key.cells();
+        if (_budget) {
+            capacity = 1;
+            while (capacity * 2 * slotSize() <= _budget)
+                capacity *= 2;
+            if (capacity < INITIAL_CAPACITY)
+                throw std::runtime_error("The memory budget is too small for the closed list");
+        }
+        reserve(capacity);
+    }
+
+    void grow() {
+        if (_budget)
+            throw std::runtime_error("Memory budget reached, the closed list is full with "
+                + std::to_string(_size) + " states");
+        std::unique_ptr<uint8_t[]> control(std::move(_control));
+        std::unique_ptr<uint64_t[]> keys(std::move(_keys));
+        std::unique_ptr<Value[]> values(std::move(_values));
+        size_t capacity = _capacity;
+
+        reserve(capacity * 2);
+        for (size_t i = 0; i < capacity; i++) {
+            if (control[i] == EMPTY)
+                continue;
+            size_t slot = Board::hash(&keys[i * _words], _words, _cells) & (_capacity - 1);
+            while (_control[slot] != EMPTY)
+                slot = (slot + 1) & (_capacity - 1);
+            _control[slot] = control[i];
+            std::memcpy(&_keys[slot * _words], &keys[i * _words], _words * sizeof(uint64_t));
+            _values[slot] = values[i];
+        }
+    }
+
+    size_t                          _budget; // in bytes, 0 for none
+    size_t                          _words; // per board
+    size_t                          _cells;
+    size_t                          _capacity; // power of 2
+    size_t                          _size;
+    std::unique_ptr<uint8_t[]>      _control;
+    std::unique_ptr<uint64_t[]>     _keys;
+    std::unique_ptr<Value[]>        _values;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <stdexcept>
+#include <cstddef>
+
+// Time limit of the searches run by a thread : the engines check it every CHECK_PERIOD expansions and
+// stop with Deadline::Expired once it is past. Threads that never set one search without limit.
+class Deadline {
+  public:
+    static const size_t CHECK_PERIOD = 1 << 12; // expansions, reading the clock on each one would show
+
+    class Expired : public std::runtime_error {
+      public:
+        Expired() : std::runtime_error("Time limit reached") {}
+    };
+
+    // the searches of this thread started from now on stop after seconds, 0 for no limit
+    static void set(double seconds) {
+        _limited = seconds > 0;
+        if (_limited)
+            _at = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(seconds));
+    }
+
+    // limit of the searches of this thread, to hand over to the threads that help it
+    static std::chrono::steady_clock::time_point at() {
+        return _limited ? _at : std::chrono::steady_clock::time_point::max();
+    }
+
+    static void set(std::chrono::steady_clock::time_point at) {
+        _limited = at != std::chrono::steady_clock::time_point::max();
+        _at = at;
+    }
+
+    static void check(size_t expansions) {
+        if (_limited && expansions % CHECK_PERIOD == 0 && std::chrono::steady_clock::now() > _at)
+            throw Expired();
+    }
+
+  private:
+    static thread_local bool                                        _limited;
+    static thread_local std::chrono::steady_clock::time_point       _at;
+};
+
+thread_local bool Deadline::_limited = false;
+thread_local std::chrono::steady_clock::time_point Deadline::_at;
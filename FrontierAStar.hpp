@@ -0,0 +1,152 @@
+#pragma once
+
+#include "GameState.hpp"
+#include "Generators.hpp"
+#include "Deadline.hpp"
+#include "IDAStar.hpp"
+#include "BucketQueue.hpp"
+#include "NodePool.hpp"
+#include "Solution.hpp"
+#include "ClosedList.hpp"
+#include <vector>
+#include <limits>
+#include <utility>
+
+// Frontier A* (Korf et al. 2005) : A* without a closed list. Each open state keeps the moves that lead
+// to states already expanded, set by them when they generated it, so that it never generates them again :
+// a state is forgotten as soon as it is expanded. Without parents, the path is rebuilt by divide and
+// conquer : a first search finds the length of the solution, then each search records on every state
+// its ancestor halfway from the start (the relay), and both halves around the relay of the solution are
+// solved the same way, down to SMALL moves solved by IDA*. Needs a consistent heuristic (all of them here).
+// An open state is kept twice, as a state in the pool to be expanded and as a board in the frontier, and the
+// relays are kept until the search ends : the memory counts all three.
+class FrontierAStar {
+  public:
+    static const size_t SMALL = 16; // moves, IDA* only keeps its path
+
+    FrontierAStar(const GameState& initial, const GameState& solution, const heuristic_t& heuristic):
+        _initial(initial),
+        _solution(solution),
+        _heuristic(heuristic),
+        _total_states(0),
+        _max_ressource(0)
+    {}
+
+    Solution solve() {
+        size_t length = search(_initial, _solution, _heuristic, NOT_FOUND).first;
+
+        if (length == NOT_FOUND)
+            return Solution();
+        return path(_initial, _solution, length);
+    }
+
+    size_t totalStates() const {
+        return _total_states;
+    }
+
+    size_t maxRessource() const {
+        return _max_ressource;
+    }
+
+  private:
+    static const size_t NOT_FOUND = std::numeric_limits<size_t>::max();
+    static const uint32_t NO_RELAY = std::numeric_limits<uint32_t>::max();
+
+    struct Record {
+        uint32_t    depth; // shortest found
+        uint32_t    relay; // index in the relays, NO_RELAY before the relay depth
+        uint8_t     used; // bit of each move leading to an expanded state
+    };
+
+    // shortest path from start to target, known to be length moves long
+    Solution path(const GameState& start, const GameState& target, size_t length) {
+        heuristic_t heuristic = target == _solution ? _heuristic : _heuristic.towardsAnyState();
+
+        if (length <= SMALL) {
+            IDAStar ida(start, target, heuristic);
+            Solution solution = ida.solve();
+            _total_states += ida.totalStates();
+            return solution;
+        }
+        GameState relay(board(search(start, target, heuristic, length / 2).second, start.size()), start.size());
+        Solution solution = path(start, relay, length / 2);
+        for (auto move : path(relay, target, length - length / 2))
+            solution.push_back(move);
+        return solution;
+    }
+
+    // length of the shortest path from start to target, and the state at relay_depth on it
+    std::pair<size_t, Board> search(const GameState& start, const GameState& target, const heuristic_t& heuristic, size_t relay_depth) {
+        BucketQueue<uint32_t> open; // handles of the states, by f then h
+        NodePool<GameState> states;
+        ClosedList<Record> frontier(_heuristic.memory); // the open states only
+        std::vector<Board> relays;
+        GameState first(start);
+
+        first.setHeuristicScore(heuristic.full(first, target));
+        frontier.insert(first.key(), Record{0, NO_RELAY, 0});
+        open.push(first.getDepth() + first.getHeuristicScore(), first.getHeuristicScore(), states.store(std::move(first)));
+        while (!open.empty()) {
+            uint32_t handle = open.pop();
+            GameState& current = states[handle];
+            Record *found = frontier.find(current.key());
+
+            if (!found || found->depth < current.getDepth()) { // expanded, or reached again by a shorter path since
+                states.release(handle);
+                continue;
+            }
+            Record record = *found;
+            if (current == target)
+                return std::make_pair(current.getDepth(), record.relay == NO_RELAY ? Board() : relays[record.relay]);
+            frontier.erase(current.key());
+            for (auto& move : GameState::directions) {
+                if (record.used & (1 << move.first))
+                    continue;
+                GameState::Point neighbor = current.neighbor(move.first);
+                if (!neighbor.in_bounds(current.size()))
+                    continue;
+                GameState next(current);
+                next.setHeuristicScore(next.getHeuristicScore() + heuristic.update(next, target, neighbor));
+                next.swap(neighbor);
+                uint8_t back = 1 << GameState::opposite(move.first);
+                auto visit = frontier.insert(next.key(), Record{(uint32_t)next.getDepth(), record.relay, back});
+                if (!visit.second) {
+                    visit.first->used |= back;
+                    if (visit.first->depth <= next.getDepth())
+                        continue;
+                    visit.first->depth = next.getDepth();
+                    visit.first->relay = record.relay;
+                }
+                if (next.getDepth() == relay_depth) {
+                    visit.first->relay = relays.size();
+                    relays.push_back(next.key());
+                }
+                open.push(next.getDepth() + next.getHeuristicScore(), next.getHeuristicScore(), states.store(std::move(next)));
+            }
+            states.release(handle);
+            if (states.size() + frontier.size() + relays.size() > _max_ressource)
+                _max_ressource = states.size() + frontier.size() + relays.size();
+            _total_states++;
+            Deadline::check(_total_states);
+        }
+        return std::make_pair(NOT_FOUND, Board());
+    }
+
+    static Data board(const Board& key, size_t size) {
+        Data data(size * size);
+
+        for (size_t i = 0; i < data.size(); i++)
+            data[i] = key.get(i);
+        return data;
+    }
+
+    const GameState&        _initial;
+    const GameState&        _solution;
+    const heuristic_t&      _heuristic;
+    size_t                  _total_states;
+    size_t                  _max_ressource;
+};
+
+const size_t FrontierAStar::SMALL;
+const size_t FrontierAStar::NOT_FOUND;
+const uint32_t FrontierAStar::NO_RELAY;
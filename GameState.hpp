@@ -5,9 +5,10 @@
 #include <vector>
 #include <iomanip>
 #include <algorithm>
-#include <map>
+#include <array>
+#include <utility>
 #include <memory>
-#include "RandomTable.hpp"
+#include "Board.hpp"
 
 class GameState {
   public:
@@ -78,78 +79,48 @@ class GameState {
         UP
     };
 
-    static std::map<Direction, Point> directions;
+    static const std::array<std::pair<Direction, Point>, 4> directions; // indexed by direction
+    static const uint64_t NO_KEYS = ~(uint64_t)0;
 
-    GameState(const std::vector<int>& data, size_t size, const RandomTable &table) : _data(data), _size(size), _table(table), _depth(0) {
-        _hash = 0;
-        for (size_t i = 0; i < _data.size(); ++i)
-            if (_data[i] != 0)
-                _hash ^= _table(_data[i], i % _size, (size_t)(i / _size));
-        _reverseData.resize(_data.size());
-        for (size_t i = 0; i < _data.size(); i++) {
-            _reverseData[_data[i]] = i;
+    GameState(const std::vector<int>& data, size_t size) : _data(data.size()), _reverseData(data.size()), _size(size), _depth(0), _heuristicKeys(NO_KEYS) {
+        for (size_t i = 0; i < data.size(); i++) {
+            _data.set(i, data[i]);
+            _reverseData.set(data[i], i);
         }
         _zero = getPoint(find(0));
-        // std::cout << "constructor" << std::endl;
-    }
-
-    GameState(const GameState& rhs): _table(rhs._table) {
-        _data = rhs._data;
-        _size = rhs._size;
-        _hash = rhs._hash;
-        _reverseData = rhs._reverseData;
-        _zero = rhs._zero;
-        _depth = rhs._depth;
-        _heuristicScore = rhs._heuristicScore;
-        _redundantMove = rhs._redundantMove;
-        // std::cout << "copy constructor" << std::endl;
-    }
-
-    GameState(GameState&& rhs): _table(rhs._table) {
-        _data = std::move(rhs._data);
-        _reverseData = std::move(rhs._reverseData);
-        _size = rhs._size;
-        _hash = rhs._hash;
-        _zero = rhs._zero;
-        _depth = rhs._depth;
-        _heuristicScore = rhs._heuristicScore;
-        _redundantMove = rhs._redundantMove;
-        // std::cout << "move constructor" << std::endl;
-    }
-
-    virtual ~GameState() {}
-
-    GameState& operator=(GameState&& rhs)
-    {
-        _data = std::move(rhs._data);
-        _reverseData = std::move(rhs._reverseData);
-        _size = rhs._size;
-        _hash = rhs._hash;
-        _zero = rhs._zero;
-        _depth = rhs._depth;
-        _heuristicScore = rhs._heuristicScore;
-        _redundantMove = rhs._redundantMove;
-        // std::cout << "move operator" << std::endl;
-        return *this;
+    }
+
+    static Direction opposite(Direction d) { // move that undoes d
+        return (Direction)((d + 2) % 4);
     }
 
     Point neighbor(Direction d) const {
-        return _zero + directions[d];
+        return _zero + directions[d].second;
     }
 
     void swap(Point &neighbor) {
-        int nb = (*this)[neighbor];
-        _hash ^= _table(nb, neighbor.x, neighbor.y);
-        _hash ^= _table(nb, _zero.x, _zero.y);
-        std::swap((*this)[_zero], (*this)[neighbor]);
-        _reverseData[0] = getIndex(neighbor); 
-        _reverseData[(*this)[_zero]] = getIndex(_zero);
+        size_t from = getIndex(neighbor);
+        size_t to = getIndex(_zero);
+        size_t nb = _data.get(from);
+        _data.set(to, nb);
+        _data.set(from, 0);
+        _reverseData.set(nb, to);
+        _reverseData.set(0, from);
         _zero = neighbor;
         ++_depth;
     }
 
+    void unswap(Point &previous) { // undoes the last swap, previous is where the empty box was before it
+        swap(previous);
+        _depth -= 2;
+    }
+
+    const Point& zero() const {
+        return _zero;
+    }
+
     size_t find(size_t value) const {
-        return _reverseData[value];
+        return _reverseData.get(value);
     }
 
     void setHeuristicScore(size_t score) {
@@ -160,15 +131,42 @@ class GameState {
         return _heuristicScore;
     }
 
+    // what the heuristic keeps of this state to update the score of its children, NO_KEYS if nothing
+    void setHeuristicKeys(uint64_t keys) {
+        _heuristicKeys = keys;
+    }
+
+    uint64_t getHeuristicKeys() const {
+        return _heuristicKeys;
+    }
+
     size_t getDepth() const {
         return _depth;
     }
 
+    size_t getFScore() const { // priority in the open lists, the depth is ignored by the greedy search
+        return _heuristicScore * _hWeight + _depth * _gWeight;
+    }
+
+    // weights of the depth and the heuristic for a weight w on the heuristic, as a fraction : (1, 1) for
+    // A*, (2, 3) for 1.5, so that f = depth + w * heuristic stays an integer (scaled by the depth weight)
+    static void weights(double weight, size_t &g, size_t &h) {
+        g = 100;
+        h = weight * 100 + 0.5;
+        size_t a = g, b = h;
+        while (b) {
+            std::swap(a, b);
+            b %= a;
+        }
+        g /= a;
+        h /= a;
+    }
+
     static size_t noHeuristic(const GameState &, const GameState &) {
         return 0;
     }
 
-    static int updateNoHeuristic(const GameState &, const GameState &, const Point &) {
+    static int updateNoHeuristic(GameState &, const GameState &, const Point &) {
         return 0;
     }
 
@@ -176,14 +174,14 @@ class GameState {
         size_t distance = 0;
         if (rhs._size != lhs._size)
             throw std::invalid_argument("GameStates have different size");
-        for (size_t i = 1; i < lhs._reverseData.size(); i++) { // skip 0 (empty box)
+        for (size_t i = 1; i < lhs._reverseData.cells(); i++) { // skip 0 (empty box)
             Point p = lhs.getPoint(lhs.find(i));
             distance += p.distance(rhs.getPoint(rhs.find(i)));
         }
         return distance;
     }
 
-    static int updateManhattan(const GameState &lhs, const GameState &rhs, const Point &neighbor) { 
+    static int updateManhattan(GameState &lhs, const GameState &rhs, const Point &neighbor) { 
         if (rhs._size != lhs._size)
             throw std::invalid_argument("GameStates have different size");
         Point dest = rhs.getPoint(rhs.find(lhs[neighbor]));
@@ -191,134 +189,37 @@ class GameState {
         return p.distance(dest) - neighbor.distance(dest);
     }
 
-    static size_t countInversions(const GameState &lhs, const GameState &rhs) {
-        size_t conflict = 0;
-        std::vector<bool> right_column(lhs._size * lhs._size, false);
-        std::vector<bool> right_row(lhs._size * lhs._size, false);
-
-        if (rhs._size != lhs._size)
-            throw std::invalid_argument("GameStates have different size");
-        for (size_t i = 1; i < lhs._reverseData.size(); i++) { // skip 0 (empty box)
-            Point p = lhs.getPoint(lhs.find(i));
-            if (p.x == rhs.getPoint(rhs.find(i)).x) {
-                right_row[lhs.find(i)] = true;
-            }
-            if (p.y == rhs.getPoint(rhs.find(i)).y) { // true if right column AND wrong line
-                right_column[lhs.find(i)] = true; // index is the index, we don't care about the value in this function
-            }
-        }
-        Point p = lhs.getPoint(0);
-        Point tmp;
-        for (p.y = 0; (size_t)p.y < lhs._size; p.y++) {
-            for (p.x = 0; (size_t)p.x < lhs._size; p.x++) { // for each box except 0
-                if (lhs[p] == 0)
-                    continue;
-                if (right_row[lhs.getIndex(p)]) {
-                    tmp = p;
-                    while((size_t)tmp.y < lhs._size - 1) {
-                        tmp += directions[DOWN];
-                        if (lhs[tmp] != 0 && right_row[lhs.getIndex(tmp)]) // find a box that is in it's right line too
-                            conflict += rhs.getPoint(rhs.find(lhs[p])).y > rhs.getPoint(rhs.find(lhs[tmp])).y; // check if boxes are switched (here we always have p.y > tmp.y so if final_p.y < final_tmp.y then we have a conflict)
-                    }
-                }
-                if (right_column[lhs.getIndex(p)]) {
-                    tmp = p;
-                    while((size_t)tmp.x < lhs._size - 1) {
-                        tmp += directions[RIGHT];
-                        if (lhs[tmp] != 0 && right_column[lhs.getIndex(tmp)])
-                            conflict += rhs.getPoint(rhs.find(lhs[p])).x > rhs.getPoint(rhs.find(lhs[tmp])).x;
-                    }
-                }
-            }
-        }
-        return conflict;
-    }
-
-    static int countColumnInversions(const GameState &lhs, const GameState &rhs, const Point &point, const int value) {
-        size_t  conflict = 0;
-        Point   other;
-        Point   other_dest;
-        Point   dest = rhs.getPoint(rhs.find(value));
-
-        if (point.x == dest.x) {
-            for (other = Point(point.x, 0); other.y < (int)lhs._size; other += directions[DOWN]) {
-                other_dest = rhs.getPoint(rhs.find(lhs[other]));
-                if (lhs[other] != value && lhs[other] != 0
-                    && other.x == other_dest.x) {
-                    if (other.y > point.y)
-                        conflict += dest.y > other_dest.y;
-                    else
-                        conflict += dest.y < other_dest.y;
-                }
-            }
-        }
-        return conflict;
-    }
-
-    static int countRowInversions(const GameState &lhs, const GameState &rhs, const Point &point, const int value)
-    {
-        size_t conflict = 0;
-        Point   other;
-        Point   other_dest;
-        Point dest = rhs.getPoint(rhs.find(value));
-
-        if (point.y == dest.y) {
-            for (other = Point(0, point.y);
-                 other.x < (int)lhs._size;
-                 other += directions[RIGHT]) {
-                other_dest = rhs.getPoint(rhs.find(lhs[other]));
-                if (lhs[other] != value && lhs[other] != 0
-                && other.y == other_dest.y) {
-                    if (other.x > point.x)
-                        conflict += dest.x > other_dest.x;
-                    else
-                        conflict += dest.x < other_dest.x;
-                }
-            }
-        }
-        return conflict;
-    }
-
-    static int updateInversions(const GameState &lhs, const GameState &rhs, const Point &neighbor) {
-        if (rhs._size != lhs._size)
-            throw std::invalid_argument("GameStates have different size");
-        if (neighbor.x == lhs._zero.x)
-            return countRowInversions(lhs, rhs, lhs._zero, lhs[neighbor])
-                 - countRowInversions(lhs, rhs, neighbor, lhs[neighbor]);
-        else
-            return countColumnInversions(lhs, rhs, lhs._zero, lhs[neighbor])
-                 - countColumnInversions(lhs, rhs, neighbor, lhs[neighbor]);
-    }
-
-    bool isSolvable() {
-        int conflict = 0;
-        bool solvable_solution = ((_size - 2) / 4) % 2;
-
-        for (size_t i = 1; i < _reverseData.size() - 1; i++) { // skip 0 (empty box)
-            for (size_t j = i + 1; j < _reverseData.size(); j++) {
-                if (_reverseData[i] > _reverseData[j])
-                    conflict++;
+    // the parity of the inversions between the tiles read line by line is the parity of their permutation,
+    // the number of tiles minus the number of its cycles
+    bool isSolvable() const {
+        size_t tiles = _reverseData.cells() - 1;
+        size_t empty = _reverseData.get(0);
+        std::vector<bool> seen(tiles, false);
+        size_t cycles = 0;
+        bool solvable_solution = ((size() - 2) / 4) % 2;
+
+        for (size_t i = 0; i < tiles; i++) {
+            if (seen[i])
+                continue;
+            cycles++;
+            for (size_t j = i; !seen[j]; ) { // tile j + 1, and the rank of its box among the tiles
+                size_t index = _reverseData.get(j + 1);
+                seen[j] = true;
+                j = index - (index > empty);
             }
         }
-        if (_size % 2 || (_size - _zero.y) % 2 == 0)
+        size_t conflict = tiles - cycles;
+        if (size() % 2 || (size() - _zero.y) % 2 == 0)
             return conflict % 2 != solvable_solution;
         else
             return conflict % 2 == solvable_solution;
     }
 
-    static size_t linearConflict(const GameState &lhs, const GameState &rhs) {  // heuristic nb 2
-        return  manhattan(lhs, rhs) + countInversions(lhs, rhs) * 2;
-    }
-
-    static int updateLinearConflict(const GameState &lhs, const GameState &rhs, const Point &neighbor) {
-        return (updateManhattan(lhs, rhs, neighbor) + updateInversions(lhs, rhs, neighbor) * 2);
-    }
-
     static size_t hamming(const GameState &lhs, const GameState &rhs) { // heuristic nb 3
         size_t out = 0;
         if (rhs._size != lhs._size)
             throw std::invalid_argument("GameStates have different size");
-        for (size_t i = 1; i < lhs._reverseData.size(); i++) { // skip 0 (empty box)
+        for (size_t i = 1; i < lhs._reverseData.cells(); i++) { // skip 0 (empty box)
             Point p = lhs.getPoint(lhs.find(i));
             if (p.x != rhs.getPoint(rhs.find(i)).x && p.y != rhs.getPoint(rhs.find(i)).y)
                 out++;
@@ -326,7 +227,7 @@ class GameState {
         return out;
     }
 
-    static int updateHamming(const GameState &lhs, const GameState &rhs, const Point &neighbor) {
+    static int updateHamming(GameState &lhs, const GameState &rhs, const Point &neighbor) {
         Point dest = rhs.getPoint(rhs.find(lhs[neighbor]));
         return (lhs._zero.x != dest.x && lhs._zero.y != dest.y)
              - (neighbor.x != dest.x && neighbor.y != dest.y);
@@ -337,7 +238,11 @@ class GameState {
     }
 
     uint64_t hash() const {
-        return _hash;
+        return _data.hash();
+    }
+
+    const Board& key() const { // exact key of the state, the position of each tile
+        return _data;
     }
 
     Point getPoint(size_t index) const {
@@ -345,7 +250,7 @@ class GameState {
     }
 
     int getIndex(const Point& p) const {
-        return p.y * _size + p.x;
+        return p.y * size() + p.x;
     }
 
     void setRedondant(const Point& p) {
@@ -357,23 +262,11 @@ class GameState {
     }
 
     int operator[](Point p) const {
-        return _data[p.x + p.y * _size];
-    }
-
-    int& operator[](Point p) {
-        return _data[p.x + p.y * _size];
-    }
-
-    friend bool operator>(const GameState &lhs, const GameState &rhs) {
-        size_t f_l = lhs._heuristicScore + lhs._depth * _g;
-        size_t f_r = rhs._heuristicScore + rhs._depth * _g;
-        if (f_l == f_r)
-            return lhs._heuristicScore > rhs._heuristicScore;
-        return f_l > f_r;
+        return _data.get(p.x + p.y * size());
     }
 
     friend bool operator==(const GameState &lhs, const GameState &rhs) {
-        return lhs._hash == rhs._hash;
+        return lhs._data == rhs._data;
     }
 
     friend bool operator!=(const GameState &lhs, const GameState &rhs) {
@@ -381,43 +274,43 @@ class GameState {
     }
 
     friend std::ostream& operator<<(std::ostream& os, const GameState& table) {
-        for (size_t i = 0; i < table._size; i++) {
-            for (size_t j = 0; j < table._size; j++)
-                if (table._data[i * table._size + j])
-                    os << std::setfill(' ') << std::setw(4) << table._data[i * table._size + j] << " ";
+        for (size_t i = 0; i < table.size(); i++) {
+            for (size_t j = 0; j < table.size(); j++)
+                if (table._data.get(i * table.size() + j))
+                    os << std::setfill(' ') << std::setw(4) << table._data.get(i * table.size() + j) << " ";
                 else
                     os << std::setfill(' ') << std::setw(4) << " " << " ";
-            os << std::endl;
+            os << '\n';
         }
         // REVERSE DATA :
-        // for (size_t i = 0; i < table._size; i++) {
-        //     for (size_t j = 0; j < table._size; j++)
-        //         os << std::setfill(' ') << std::setw(4) << table._reverseData[i * table._size + j] << " ";
+        // for (size_t i = 0; i < table.size(); i++) {
+        //     for (size_t j = 0; j < table.size(); j++)
+        //         os << std::setfill(' ') << std::setw(4) << table._reverseData.get(i * table.size() + j) << " ";
         //     os << std::endl;
         // }
         return os;
     }
-    static bool             _g;
+    static size_t           _gWeight; // 0 for the greedy search
+    static size_t           _hWeight;
 
   private:
-    std::vector<int>        _data;
-    std::vector<int>        _reverseData; // gives the index of the value in the _data vector, will speed up the heuristic calculations
+    Board                   _data;
+    Board                   _reverseData; // gives the index of the value in _data, will speed up the heuristic calculations
     size_t                  _size;
-    uint64_t                _hash;
     Point                   _zero;
-    const RandomTable&      _table;
     size_t                  _depth;
     size_t                  _heuristicScore;
+    uint64_t                _heuristicKeys;
     Point                   _redundantMove;
-
-    GameState& operator=(const GameState&) = delete;
 };
 
-std::map<GameState::Direction, GameState::Point> GameState::directions = {
+const std::array<std::pair<GameState::Direction, GameState::Point>, 4> GameState::directions = {{
     {RIGHT, Point(1, 0)},
     {DOWN, Point(0, 1)},
     {LEFT, Point(-1, 0)},
     {UP, Point(0, -1)}
-};
+}};
 
-bool GameState::_g = true;
+const uint64_t GameState::NO_KEYS;
+size_t GameState::_gWeight = 1;
+size_t GameState::_hWeight = 1;
@@ -1,29 +1,92 @@
 #pragma once
 #include "GameState.hpp"
+#include "PatternDatabase.hpp"
+#include "WalkingDistance.hpp"
+#include "LinearConflict.hpp"
+#include "Solution.hpp"
+#include "BlockWriter.hpp"
 #include <algorithm>
 #include <fstream>
 #include <cstring>
 #include <memory>
 #include <utility>
+#include <random>
+#include <charconv>
+#include <cerrno>
 #include <getopt.h>
-#include "RandomTable.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 typedef std::vector<int> Data;
 typedef size_t (*heuristic_f)(const GameState &lhs, const GameState &rhs);
-typedef int (*update_heuristic_f)(const GameState &lhs, const GameState &rhs, const GameState::Point &point);
+// lhs is the state about to move the tile of point into its empty box : the heuristic can leave in it the
+// keys of the child, which they describe once it is swapped
+typedef int (*update_heuristic_f)(GameState &lhs, const GameState &rhs, const GameState::Point &point);
+
+enum engine_e {
+    ASTAR,
+    IDASTAR,
+    BIDIRECTIONAL,
+    ARASTAR,
+    FRONTIER,
+    SUBGOALS // not optimal, for the large boards
+};
+
+enum display_e {
+    ANIMATE, // one state per line read on the standard input
+    ALL_STATES,
+    FINAL_STATE,
+    MOVES // only the moves, as letters
+};
 
 struct heuristic_t {
-    heuristic_t(): greedy(false), full(&GameState::noHeuristic), update(&GameState::updateNoHeuristic) {}
+    heuristic_t(): greedy(false), weight(1), engine(ASTAR), threads(1), memory(0), display(ANIMATE), full(&GameState::noHeuristic), update(&GameState::updateNoHeuristic), timeout(0), count(0), difficulty(0), partial(false) {}
 
     bool greedy;
+    double weight; // of the heuristic, solutions are at most weight times longer than the shortest
+    engine_e engine;
+    size_t threads;
+    size_t memory; // budget of the closed lists in bytes, 0 to let them grow
+    display_e display;
     heuristic_f full;
     update_heuristic_f update;
+    std::string database; // pattern database file, default name if empty
+    std::string database_groups; // sizes of the pattern database groups (6-6-3), default for the size if empty
+    std::string batch; // file of puzzles to solve, - for the standard input, empty to solve a single map
+    std::string stats; // format of the search statistics printed instead of the solution, empty to play it
+    std::string cache; // file of the solutions already found, empty for none
+    std::string serve; // socket to serve puzzles on, - for the standard input, empty to solve a single map
+    double timeout; // seconds given to each search, 0 for no limit
+    size_t count; // random maps printed instead of solving one, 0 to solve
+    size_t difficulty; // moves of the random walk that makes each of them, 0 for a shuffle
+    bool partial; // A* only stores the children of the f their parent is queued with
+
+    // builds or maps the tables of the heuristics that need them, for the given solution
+    void loadTables(const Data& solution) const {
+        if (full == &PatternDatabase::pdb)
+            PatternDatabase::load(solution, database_groups, database);
+        if (full == &WalkingDistance::walkingDistance || full == &WalkingDistance::walkingConflict)
+            WalkingDistance::load(solution);
+    }
+
+    // same settings with a heuristic that works towards any state : the tables of the pattern database
+    // and walking distance heuristics are only built for the solution, manhattan distance replaces them
+    heuristic_t towardsAnyState() const {
+        heuristic_t heuristic(*this);
+        if (full == &PatternDatabase::pdb || full == &WalkingDistance::walkingDistance || full == &WalkingDistance::walkingConflict) {
+            heuristic.full = &GameState::manhattan;
+            heuristic.update = &GameState::updateManhattan;
+        }
+        return heuristic;
+    }
 };
 
 class Generators {
   public:
 
-    Generators() : _size(0) {}
+    Generators() : _size(0), _seed(std::random_device()()) {}
 
     class ParsingException : public std::exception {
         public:
@@ -35,17 +98,112 @@ class Generators {
             std::string _message;
     };
 
-    class FileReader : public std::ifstream {
+    // Input of the parser, read line by line without copies : a regular file is mapped in memory, other
+    // inputs (pipes, terminals) are read in blocks into a buffer, and each line points into one or the
+    // other until the next one is read. Can also read the lines of a buffer already in memory.
+    class FileReader {
         public:
-            FileReader(std::string filename) : std::ifstream(filename) {}
-            ~FileReader() { close(); }
+            static const size_t BLOCK = 1 << 16;
+
+            FileReader(const std::string& filename) : _fd(open(filename.c_str(), O_RDONLY)), _owned(true) {
+                start();
+            }
+
+            FileReader(int fd) : _fd(fd), _owned(false) {
+                start();
+            }
+
+            FileReader(const char *begin, const char *end) : _fd(-1), _owned(false), _map(MAP_FAILED), _pos(begin), _end(end), _eof(true) {}
+
+            FileReader(const FileReader&) = delete;
+            FileReader& operator=(const FileReader&) = delete;
+
+            ~FileReader() {
+                if (_map != MAP_FAILED)
+                    munmap(_map, _end - static_cast<const char *>(_map));
+                if (_owned && _fd >= 0)
+                    ::close(_fd);
+            }
+
+            bool is_open() const {
+                return _fd >= 0 || !_owned;
+            }
+
+            // the next line, without its end, false at the end of the input
+            bool getline(const char *&begin, const char *&end) {
+                const char *newline;
+
+                while ((newline = _pos == _end ? nullptr : static_cast<const char *>(std::memchr(_pos, '\n', _end - _pos))) == nullptr && !_eof)
+                    fill();
+                if (_pos == _end)
+                    return false;
+                begin = _pos;
+                end = newline ? newline : _end;
+                _pos = newline ? newline + 1 : _end;
+                return true;
+            }
+
+        private:
+            void start() {
+                struct stat st;
+
+                _map = MAP_FAILED;
+                _pos = _end = nullptr;
+                _eof = _fd < 0;
+                if (_fd >= 0 && fstat(_fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+                    _map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, _fd, 0);
+                if (_map != MAP_FAILED) {
+                    _pos = static_cast<const char *>(_map);
+                    _end = _pos + st.st_size;
+                    _eof = true;
+                }
+            }
+
+            // keeps the line started, then reads the next block after it
+            void fill() {
+                size_t kept = _end - _pos;
+
+                if (kept && _pos != _buffer.data())
+                    std::memmove(_buffer.data(), _pos, kept);
+                if (_buffer.size() < kept + BLOCK)
+                    _buffer.resize(kept + BLOCK);
+                ssize_t count;
+                do
+                    count = read(_fd, _buffer.data() + kept, _buffer.size() - kept);
+                while (count < 0 && errno == EINTR);
+                _eof = count <= 0;
+                _pos = _buffer.data();
+                _end = _pos + kept + (count > 0 ? count : 0);
+            }
+
+            int                 _fd;
+            bool                _owned;
+            void                *_map;
+            std::vector<char>   _buffer;
+            const char          *_pos;
+            const char          *_end;
+            bool                _eof;
     };
 
-    void skip_whitespace(std::string &line, size_t &pos) {
-        while (pos < line.size() && isspace(line[pos]))
+    void skip_whitespace(const char *&pos, const char *end) {
+        while (pos < end && isspace(*pos))
             pos++;
     }
 
+    // a number where std::stoi would read one, with its errors
+    int read_number(const char *&pos, const char *end) {
+        const char *start = pos + (*pos == '+' && end - pos > 1 && pos[1] != '-');
+        int nb;
+        auto result = std::from_chars(start, end, nb);
+
+        if (result.ec == std::errc::invalid_argument)
+            throw ParsingException("Invalid character in table");
+        if (result.ec == std::errc::result_out_of_range)
+            throw ParsingException("Number too large in table");
+        pos = result.ptr;
+        return nb;
+    }
+
     heuristic_t setHeuristic(int ac, char **av)
     {
         static struct option long_options[] = {
@@ -53,20 +211,44 @@ class Generators {
             {"linear-conflict", no_argument, 0, 'l'},
             {"hamming", no_argument, 0, 'h'},
             {"greedy", no_argument, 0, 'g'},
+            {"weight", required_argument, 0, 'w'},
+            {"anytime", no_argument, 0, 'a'},
+            {"ida", no_argument, 0, 'i'},
+            {"bidirectional", no_argument, 0, 'b'},
+            {"frontier", no_argument, 0, 'f'},
+            {"large", no_argument, 0, 'L'},
+            {"partial", no_argument, 0, 'E'},
+            {"jobs", required_argument, 0, 'j'},
+            {"pdb", optional_argument, 0, 'p'},
+            {"pdb-groups", required_argument, 0, 'P'},
+            {"walking-distance", no_argument, 0, 'd'},
+            {"walking-conflict", no_argument, 0, 'c'},
+            {"batch", required_argument, 0, 'B'},
+            {"seed", required_argument, 0, 'S'},
+            {"stats", required_argument, 0, 's'},
+            {"memory", required_argument, 0, 'M'},
+            {"cache", required_argument, 0, 'C'},
+            {"serve", required_argument, 0, 'V'},
+            {"timeout", required_argument, 0, 'T'},
+            {"count", required_argument, 0, 'K'},
+            {"difficulty", required_argument, 0, 'D'},
+            {"no-animate", no_argument, 0, 'N'},
+            {"final-only", no_argument, 0, 'F'},
+            {"moves-only", no_argument, 0, 'O'},
             {0,0,0,0}
         };
         heuristic_t heuristic;
         int c;
         int long_index;
-        while ((c = getopt_long(ac, av, "mlhg", long_options, &long_index)) != -1)
+        while ((c = getopt_long(ac, av, "mlhgw:aibfj:p::dc", long_options, &long_index)) != -1)
             switch (c) {
                 case 'm':
                     heuristic.full = &GameState::manhattan;
                     heuristic.update = &GameState::updateManhattan;
                     break;
                 case 'l':
-                    heuristic.full = &GameState::linearConflict;
-                    heuristic.update = &GameState::updateLinearConflict;
+                    heuristic.full = &LinearConflict::linearConflict;
+                    heuristic.update = &LinearConflict::updateLinearConflict;
                     break;
                 case 'h':
                     heuristic.full = &GameState::hamming;
@@ -75,72 +257,241 @@ class Generators {
                 case 'g':
                     heuristic.greedy = true;
                     break;
+                case 'w':
+                    try {
+                        heuristic.weight = std::stod(optarg);
+                    } catch (std::exception &) {
+                        heuristic.weight = 0;
+                    }
+                    if (!(heuristic.weight >= 1 && heuristic.weight <= 100))
+                        throw std::invalid_argument("Invalid Argument: The weight must be a number between 1 and 100");
+                    break;
+                case 'a':
+                    heuristic.engine = ARASTAR;
+                    break;
+                case 'i':
+                    heuristic.engine = IDASTAR;
+                    break;
+                case 'b':
+                    heuristic.engine = BIDIRECTIONAL;
+                    break;
+                case 'f':
+                    heuristic.engine = FRONTIER;
+                    break;
+                case 'L':
+                    heuristic.engine = SUBGOALS;
+                    break;
+                case 'E':
+                    heuristic.partial = true;
+                    break;
+                case 'j':
+                    try {
+                        heuristic.threads = std::stoul(optarg);
+                    } catch (std::exception &) {
+                        heuristic.threads = 0;
+                    }
+                    if (heuristic.threads == 0)
+                        throw std::invalid_argument("Invalid Argument: The number of threads must be a positive number");
+                    break;
+                case 'p':
+                    heuristic.full = &PatternDatabase::pdb;
+                    heuristic.update = &PatternDatabase::updatePdb;
+                    if (optarg)
+                        heuristic.database = optarg;
+                    break;
+                case 'P':
+                    heuristic.database_groups = optarg;
+                    break;
+                case 'd':
+                    heuristic.full = &WalkingDistance::walkingDistance;
+                    heuristic.update = &WalkingDistance::updateWalkingDistance;
+                    break;
+                case 'c':
+                    heuristic.full = &WalkingDistance::walkingConflict;
+                    heuristic.update = &WalkingDistance::updateWalkingConflict;
+                    break;
+                case 'B':
+                    heuristic.batch = optarg;
+                    break;
+                case 'N':
+                    heuristic.display = ALL_STATES;
+                    break;
+                case 'F':
+                    heuristic.display = FINAL_STATE;
+                    break;
+                case 'O':
+                    heuristic.display = MOVES;
+                    break;
+                case 'M':
+                    try {
+                        heuristic.memory = std::stoul(optarg) << 20;
+                    } catch (std::exception &) {
+                        heuristic.memory = 0;
+                    }
+                    if (heuristic.memory == 0)
+                        throw std::invalid_argument("Invalid Argument: The memory budget must be a positive number of MB");
+                    break;
+                case 'C':
+                    heuristic.cache = optarg;
+                    break;
+                case 'V':
+                    heuristic.serve = optarg;
+                    break;
+                case 'T':
+                    try {
+                        heuristic.timeout = std::stod(optarg);
+                    } catch (std::exception &) {
+                        heuristic.timeout = 0;
+                    }
+                    if (!(heuristic.timeout > 0))
+                        throw std::invalid_argument("Invalid Argument: The time limit must be a positive number of seconds");
+                    break;
+                case 'K':
+                    try {
+                        heuristic.count = std::stoul(optarg);
+                    } catch (std::exception &) {
+                        heuristic.count = 0;
+                    }
+                    if (heuristic.count == 0)
+                        throw std::invalid_argument("Invalid Argument: The count must be a positive number");
+                    break;
+                case 'D':
+                    try {
+                        heuristic.difficulty = std::stoul(optarg);
+                    } catch (std::exception &) {
+                        heuristic.difficulty = 0;
+                    }
+                    if (heuristic.difficulty == 0)
+                        throw std::invalid_argument("Invalid Argument: The difficulty must be a positive number of moves");
+                    break;
+                case 'S':
+                    try {
+                        _seed = std::stoul(optarg);
+                    } catch (std::exception &) {
+                        throw std::invalid_argument("Invalid Argument: The seed must be a positive number");
+                    }
+                    break;
+                case 's':
+                    heuristic.stats = optarg;
+                    if (heuristic.stats != "csv" && heuristic.stats != "json")
+                        throw std::invalid_argument("Invalid Argument: The statistics format must be csv or json");
+                    break;
                 default:
                     throw std::invalid_argument("");
         }
         if (heuristic.greedy && heuristic.full == &GameState::noHeuristic)
             throw std::invalid_argument("Invalid Argument: You have to specify an heuristic to go along with the greedy option");
+        if (heuristic.greedy && heuristic.engine == IDASTAR)
+            throw std::invalid_argument("Invalid Argument: The greedy option can't be used with IDA*");
+        if (heuristic.greedy && heuristic.engine == BIDIRECTIONAL)
+            throw std::invalid_argument("Invalid Argument: The greedy option can't be used with the bidirectional search");
+        if (heuristic.greedy && heuristic.engine == FRONTIER)
+            throw std::invalid_argument("Invalid Argument: The greedy option can't be used with the frontier search");
+        if (heuristic.greedy && heuristic.engine == SUBGOALS)
+            throw std::invalid_argument("Invalid Argument: The greedy option can't be used with --large");
+        if (heuristic.weight > 1 && (heuristic.greedy || heuristic.engine == IDASTAR || heuristic.engine == BIDIRECTIONAL || heuristic.engine == FRONTIER || heuristic.engine == SUBGOALS))
+            throw std::invalid_argument("Invalid Argument: The weight can only be used with A*");
+        if (heuristic.greedy && heuristic.engine == ARASTAR)
+            throw std::invalid_argument("Invalid Argument: The greedy option can't be used with the anytime search");
+        if (heuristic.engine == ARASTAR && !heuristic.batch.empty())
+            throw std::invalid_argument("Invalid Argument: The anytime search can't be used with --batch");
+        if (heuristic.engine == ARASTAR && !heuristic.serve.empty())
+            throw std::invalid_argument("Invalid Argument: The anytime search can't be used with --serve");
+        if (!heuristic.batch.empty() && !heuristic.serve.empty())
+            throw std::invalid_argument("Invalid Argument: --batch and --serve can't be used together");
+        if (heuristic.count && (!heuristic.batch.empty() || !heuristic.serve.empty()))
+            throw std::invalid_argument("Invalid Argument: --count can't be used with --batch or --serve");
+        if (heuristic.difficulty && !heuristic.count)
+            throw std::invalid_argument("Invalid Argument: The difficulty can only be used with --count");
+        GameState::weights(heuristic.weight, GameState::_gWeight, GameState::_hWeight);
+        if (heuristic.greedy)
+            GameState::_gWeight = 0;
+        if (heuristic.partial && (heuristic.engine != ASTAR || (heuristic.threads > 1 && heuristic.batch.empty() && heuristic.serve.empty())))
+            throw std::invalid_argument("Invalid Argument: The partial expansion can only be used with A* on a single thread");
+        if (heuristic.threads > 1 && heuristic.engine != ASTAR && heuristic.engine != IDASTAR && heuristic.batch.empty() && heuristic.serve.empty())
+            throw std::invalid_argument("Invalid Argument: Only A* and IDA* can run on several threads");
         return heuristic;
     }
 
-    Data parse_file(std::ifstream &fs)
+    // reads the next table of the input, either in the map format (the size alone on its line, then one line
+    // per row) or on a single line (the size then all the values), returns false if the input ends before it starts
+    bool nextTable(FileReader &input, Data &data)
     {
-        std::string line;
+        const char  *pos;
+        const char  *end;
         size_t      line_count = 0;
         size_t      column_count;
-        size_t      pos;
         int         nb;
-        size_t      tmp_count;
-        std::vector<bool> filled;
         size_t size = 0;
-        Data data;
 
-        while (getline(fs, line))
+        while ((line_count == 0 || line_count <= size) && input.getline(pos, end))
         {
-            pos = 0;
             column_count = 0;
-            skip_whitespace(line, pos);
-            if (line[pos] == '#' || line.size() == 0)
+            skip_whitespace(pos, end);
+            if (pos == end || *pos == '#')
                 continue;
-            while (pos < line.size() && line[pos] != '#')
+            bool single_line = false;
+            while (pos < end && *pos != '#')
             {
-                nb = std::stoi(&line[pos], &tmp_count);
-                pos += tmp_count;
+                nb = read_number(pos, end);
                 if (nb < 0)
                     throw ParsingException("Negative number in table");
-                if (line_count == 0)
+                if (line_count == 0 && column_count == 0)
                 {
-                    if (column_count != 0)
-                        throw ParsingException("First line should only contain the size of the table");
-                    if (nb < 2)
-                        throw ParsingException("Table size should be at least 3");
+                    checkSize(nb);
                     size = nb;
-                    data.resize(nb * nb);
-                    filled = std::vector<bool>(nb * nb, false);
+                    data.assign(nb * nb, 0);
+                    _filled.assign(nb * nb, false);
                 }
                 else
                 {
+                    if (line_count == 0)
+                        single_line = true;
+                    size_t index = single_line ? column_count - 1 : (line_count - 1) * size + column_count;
                     if (line_count > size)
                         throw ParsingException("Too many lines in table");
                     if (nb >= (int)(size * size))
                         throw ParsingException("Number too large in table");
-                    if (column_count >= size)
+                    if (single_line && index >= size * size)
+                        throw ParsingException("Too many values in table");
+                    if (!single_line && column_count >= size)
                         throw ParsingException("Too many values on line " + std::to_string(line_count) + " of table");
-                    data[(line_count - 1) * size + column_count] = nb;
-                    if (filled[nb])
+                    data[index] = nb;
+                    if (_filled[nb])
                         throw ParsingException("Duplicate number "  + std::to_string(nb) + " in table");
-                    filled[nb] = true;
+                    _filled[nb] = true;
                 }
                 column_count++;
-                skip_whitespace(line, pos);
+                skip_whitespace(pos, end);
             }
+            if (single_line && column_count != size * size + 1)
+                throw ParsingException("Missing values in table");
             if (line_count > 0 && column_count != size)
                 throw ParsingException("Missing values on line " + std::to_string(line_count) + " of table");
-            line_count++;
+            line_count = single_line ? size + 1 : line_count + 1;
         }
-        if (line_count == 0 || line_count - 1 < size)
+        if (line_count == 0)
+            return false;
+        if (line_count - 1 < size)
             throw ParsingException("Missing lines in table");
         _size = size;
+        return true;
+    }
+
+    Data parse_file(FileReader &fs)
+    {
+        const char  *pos;
+        const char  *end;
+        Data data;
+
+        if (!nextTable(fs, data))
+            throw ParsingException("Missing lines in table");
+        while (fs.getline(pos, end))
+        {
+            skip_whitespace(pos, end);
+            if (pos < end && *pos != '#')
+                throw ParsingException("Too many lines in table");
+        }
         return data;
     }
 
@@ -150,8 +501,7 @@ class Generators {
             if (errno == 2) // No such file or directory
                 try {
                     _size = std::stoi(argument); // Try to parse argument as size of map
-                    if (_size <= 2)
-                        throw ParsingException("Table size should be at least 3");
+                    checkSize(_size);
                     return generateRandom();
                 }
                 catch (ParsingException &e) {
@@ -163,13 +513,7 @@ class Generators {
             else
                 throw ParsingException("Error opening \"" + argument + "\" : " + std::strerror(errno));
         }
-        try {
-            return parse_file(fs);
-        } catch (std::invalid_argument &e) {
-            throw ParsingException("Invalid character in table");
-        } catch (std::out_of_range &e) {
-            throw ParsingException("Number too large in table");
-        }
+        return parse_file(fs);
     }
 
     bool isEmptyBox(std::vector<int> table, const GameState::Point& p) {
@@ -202,11 +546,81 @@ class Generators {
         Data data(_size * _size);
         for (size_t i = 0; i < _size * _size; i++)
             data[i] = i;
-        std::random_shuffle(data.begin(), data.end());
+        std::mt19937 engine(_seed);
+        std::shuffle(data.begin(), data.end(), engine);
         return data;
     }
 
+    // prints count maps of the size given, one per line (size then values), all solvable : the solution after
+    // a random walk of difficulty moves of the empty box, or with difficulty 0 a shuffle where two tiles are
+    // swapped back if it is not solvable, which keeps every solvable map as likely
+    void generate(const std::string& argument, size_t count, size_t difficulty) {
+        try {
+            _size = std::stoi(argument);
+        } catch (std::exception &e) {
+            throw ParsingException("Invalid size \"" + argument + "\"");
+        }
+        checkSize(_size);
+        Data solution = generateSolution();
+        Data data(solution);
+        std::mt19937 engine(_seed);
+        std::vector<char> line(_size * _size * 6 + 8);
+        BlockWriter writer;
+        std::ostream out(&writer);
+
+        std::cout.flush();
+        for (size_t n = 0; n < count; n++) {
+            if (difficulty)
+                walk(data, solution, difficulty, engine);
+            else {
+                std::shuffle(data.begin(), data.end(), engine);
+                if (!GameState(data, _size).isSolvable())
+                    std::swap(data[data[0] ? 0 : 2], data[data[1] ? 1 : 2]);
+            }
+            char *end = std::to_chars(line.data(), line.data() + line.size(), _size).ptr;
+            for (int value : data) {
+                *end++ = ' ';
+                end = std::to_chars(end, line.data() + line.size(), value).ptr;
+            }
+            *end++ = '\n';
+            out.write(line.data(), end - line.data());
+        }
+    }
+
   private:
+    static const size_t MAX_SIZE = 256; // a line of the linear conflict is kept in arrays of 256 digits
+
+    static void checkSize(size_t size) {
+        if (size < 3 || size > MAX_SIZE)
+            throw ParsingException("Table size should be between 3 and " + std::to_string(MAX_SIZE));
+    }
+
+    // data becomes the solution after moves random moves of the empty box, none undoing the one before
+    void walk(Data& data, const Data& solution, size_t moves, std::mt19937& engine) {
+        size_t zero = std::find(solution.begin(), solution.end(), 0) - solution.begin();
+        int previous = -1;
+        size_t next[4];
+
+        data = solution;
+        for (size_t i = 0; i < moves; i++) {
+            GameState::Point empty(zero % _size, zero / _size);
+            size_t choices = 0;
+            for (auto& move : GameState::directions) {
+                GameState::Point neighbor = empty + move.second;
+                if (neighbor.in_bounds(_size) && (previous < 0 || move.first != GameState::opposite((GameState::Direction)previous)))
+                    next[choices++] = move.first;
+            }
+            previous = next[std::uniform_int_distribution<size_t>(0, choices - 1)(engine)];
+            GameState::Point neighbor = empty + GameState::directions[previous].second;
+            size_t index = neighbor.y * _size + neighbor.x;
+            std::swap(data[zero], data[index]);
+            zero = index;
+        }
+    }
 
     size_t _size;
+    std::vector<bool> _filled; // numbers already read in the table, kept from one table to the next
+    unsigned _seed; // of the random maps, drawn at start unless given
 };
+
+const size_t Generators::MAX_SIZE;
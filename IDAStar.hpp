@@ -0,0 +1,100 @@
+#pragma once
+
+#include "GameState.hpp"
+#include "Generators.hpp"
+#include "Deadline.hpp"
+#include "MovePruning.hpp"
+#include <vector>
+#include <limits>
+
+// Iterative deepening A* : depth first search bounded by a f = depth + heuristic threshold,
+// raised to the smallest f that went over it until the solution is reached.
+// Only the current path is kept in memory, the heuristic is updated on each move and restored on the way back.
+// The moves that would end the path with a useless sequence are skipped (see MovePruning).
+class IDAStar {
+  public:
+    IDAStar(const GameState& initial, const GameState& solution, const heuristic_t& heuristic):
+        _initial(initial),
+        _solution(solution),
+        _heuristic(heuristic),
+        _pruning(MovePruning::get(initial.size())),
+        _total_states(0),
+        _max_ressource(0)
+    {}
+
+    Solution solve() {
+        GameState current(_initial);
+        Solution solution;
+
+        current.setHeuristicScore(_heuristic.full(current, _solution));
+        size_t threshold = current.getHeuristicScore();
+        while (threshold != NOT_FOUND) {
+            threshold = search(current, threshold, MovePruning::START);
+            if (threshold == FOUND) {
+                for (auto move : _path)
+                    solution.push_back(move);
+                return solution;
+            }
+        }
+        return solution;
+    }
+
+    size_t totalStates() const {
+        return _total_states;
+    }
+
+    size_t maxRessource() const {
+        return _max_ressource;
+    }
+
+  private:
+    static const size_t FOUND = 0;
+    static const size_t NOT_FOUND = std::numeric_limits<size_t>::max();
+
+    // returns FOUND, or the smallest f above threshold met in this subtree
+    size_t search(GameState& current, size_t threshold, uint32_t pruning) {
+        size_t f = current.getDepth() + current.getHeuristicScore();
+        size_t next_threshold = NOT_FOUND;
+
+        if (f > threshold)
+            return f;
+        if (current == _solution)
+            return FOUND;
+        _total_states++;
+        Deadline::check(_total_states);
+        if (_path.size() + 1 > _max_ressource)
+            _max_ressource = _path.size() + 1;
+        for (auto& move : GameState::directions) {
+            uint32_t next = _pruning.next(pruning, move.first);
+            if (_pruning.pruned(next, MovePruning::ALL))
+                continue ;
+            GameState::Point neighbor = current.neighbor(move.first);
+            if (!neighbor.in_bounds(current.size()))
+                continue;
+            GameState::Point previous = current.zero();
+            size_t score = current.getHeuristicScore();
+            uint64_t keys = current.getHeuristicKeys();
+            current.setHeuristicScore(score + _heuristic.update(current, _solution, neighbor));
+            current.swap(neighbor);
+            _path.push_back(move.first);
+            size_t t = search(current, threshold, next);
+            if (t == FOUND)
+                return FOUND;
+            _path.pop_back();
+            current.unswap(previous);
+            current.setHeuristicScore(score);
+            current.setHeuristicKeys(keys);
+            if (t < next_threshold)
+                next_threshold = t;
+        }
+        return next_threshold;
+    }
+
+    const GameState&                    _initial;
+    const GameState&                    _solution;
+    const heuristic_t&                  _heuristic;
+    const MovePruning&                  _pruning;
+    size_t                              _total_states;
+    size_t                              _max_ressource;
+    std::vector<GameState::Direction>   _path;
+};
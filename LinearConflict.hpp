@@ -0,0 +1,140 @@
+#pragma once
+
+#include "GameState.hpp"
+#include <vector>
+#include <mutex>
+#include <map>
+#include <memory>
+#include <cstdint>
+
+// Linear conflict heuristic : manhattan distance, plus 2 moves for each tile that has to leave its line
+// (row or column) so that the other tiles of the line that belong to it can reach their place in order.
+// The number of tiles to remove is the number of tiles that belong to the line minus the longest sequence
+// of them already in order. It is read from one table per size, keyed by the line : one digit per box,
+// the goal position on the line of a tile that belongs to it, or the size for the empty box and the others.
+// A move only changes the goal line of the moved tile, when the tile leaves or enters it.
+class LinearConflict {
+  public:
+    static const size_t MAX_TABLE_SIZE = 7; // 8^7 lines on a 7x7, the 8x8 would need 9^8, computed on the fly above
+    static const size_t MAX_SIZE = 256; // boxes of a line, a digit can be the size itself so it takes 16 bits
+
+    static size_t linearConflict(const GameState &lhs, const GameState &rhs) {  // heuristic nb 2
+        const LinearConflict &table = get(lhs.size());
+        uint16_t digits[MAX_SIZE];
+        size_t removed = 0;
+
+        for (int line = 0; line < (int)lhs.size(); line++)
+            removed += table.removed(lhs, rhs, GameState::Point(0, line), GameState::RIGHT, digits)
+                     + table.removed(lhs, rhs, GameState::Point(line, 0), GameState::DOWN, digits);
+        return GameState::manhattan(lhs, rhs) + removed * 2;
+    }
+
+    static int updateLinearConflict(GameState &lhs, const GameState &rhs, const GameState::Point &neighbor) {
+        const GameState::Point &zero = lhs.zero();
+        GameState::Point goal = rhs.getPoint(rhs.find(lhs[neighbor]));
+        int manhattan = GameState::updateManhattan(lhs, rhs, neighbor);
+        bool vertical = neighbor.x == zero.x;
+        GameState::Point line;
+
+        // only the goal line of the moved tile changes, if it leaves or enters it (a row for a vertical move),
+        // and only on the box where the tile is along it
+        if (vertical && (goal.y == neighbor.y || goal.y == zero.y))
+            line = GameState::Point(0, goal.y);
+        else if (!vertical && (goal.x == neighbor.x || goal.x == zero.x))
+            line = GameState::Point(goal.x, 0);
+        else
+            return manhattan;
+        const LinearConflict &table = get(lhs.size());
+        uint16_t digits[MAX_SIZE];
+        size_t position = vertical ? neighbor.x : neighbor.y;
+        size_t after = (vertical ? goal.y == neighbor.y : goal.x == neighbor.x) ? lhs.size() : (vertical ? goal.x : goal.y);
+        int before = table.removed(lhs, rhs, line, vertical ? GameState::RIGHT : GameState::DOWN, digits);
+
+        digits[position] = after;
+        return manhattan + (table.removed(digits) - before) * 2;
+    }
+
+  private:
+    LinearConflict(size_t size) : _size(size) {
+        uint16_t digits[MAX_TABLE_SIZE];
+        size_t count = 1;
+
+        if (size > MAX_TABLE_SIZE)
+            return;
+        for (size_t i = 0; i < size; i++)
+            count *= size + 1;
+        _removed.resize(count);
+        for (size_t key = 0; key < count; key++) {
+            size_t rest = key;
+            for (size_t i = 0; i < size; i++, rest /= size + 1)
+                digits[i] = rest % (size + 1);
+            _removed[key] = removedTiles(digits, size);
+        }
+    }
+
+    // the tables are built the first time a size is used, sizes above MAX_TABLE_SIZE only have an empty one
+    static const LinearConflict &get(size_t size) {
+        static std::mutex lock;
+        static std::map<size_t, std::unique_ptr<LinearConflict> > tables;
+        static thread_local const LinearConflict *last = nullptr;
+
+        if (last && last->_size == size)
+            return *last;
+        std::lock_guard<std::mutex> guard(lock);
+        auto& table = tables[size];
+        if (!table)
+            table.reset(new LinearConflict(size));
+        last = table.get();
+        return *last;
+    }
+
+    // tiles to remove from a line so that the others are in order : the ones that belong to it (digits
+    // below size) minus the longest increasing sequence of them
+    static size_t removedTiles(const uint16_t *digits, size_t size) {
+        uint16_t longest[MAX_SIZE]; // longest[i] : longest increasing sequence ending at digit i
+        size_t tiles = 0;
+        size_t best = 0;
+
+        for (size_t i = 0; i < size; i++) {
+            if (digits[i] >= size)
+                continue;
+            tiles++;
+            longest[i] = 1;
+            for (size_t j = 0; j < i; j++)
+                if (digits[j] < digits[i] && longest[j] + 1 > longest[i])
+                    longest[i] = longest[j] + 1;
+            if (longest[i] > best)
+                best = longest[i];
+        }
+        return tiles - best;
+    }
+
+    size_t removed(const uint16_t *digits) const {
+        size_t key = 0;
+
+        if (_removed.empty())
+            return removedTiles(digits, _size);
+        for (size_t i = _size; i > 0; i--)
+            key = key * (_size + 1) + digits[i - 1];
+        return _removed[key];
+    }
+
+    // tiles to remove from the line that starts at start and goes along, its digits are left in digits
+    size_t removed(const GameState &lhs, const GameState &rhs, GameState::Point start, GameState::Direction along, uint16_t *digits) const {
+        const GameState::Point &step = GameState::directions[along].second;
+
+        for (size_t i = 0; i < _size; i++, start += step) {
+            int tile = lhs[start];
+            digits[i] = _size;
+            if (tile != 0) {
+                GameState::Point goal = rhs.getPoint(rhs.find(tile));
+                if (along == GameState::RIGHT ? goal.y == start.y : goal.x == start.x)
+                    digits[i] = along == GameState::RIGHT ? goal.x : goal.y;
+            }
+        }
+        return removed(digits);
+    }
+
+    size_t                  _size;
+    std::vector<uint8_t>    _removed; // tiles to remove, by line, empty above MAX_TABLE_SIZE
+};
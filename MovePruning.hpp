@@ -0,0 +1,261 @@
+#pragma once
+
+#include "GameState.hpp"
+#include <array>
+#include <deque>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+// Move pruning automaton (Taylor and Korf 1993) : a sequence of moves of the empty box is useless when
+// another one, shorter or as long and first in the order of the directions, moves the same tiles to the same
+// places without going out of the boxes it goes through, so that it works wherever the first one does.
+// The sequences of up to MAX_LENGTH moves are played on a grid by increasing length, their effect kept as
+// a hash of the whole grid, and the useless ones that contain no shorter useless sequence are kept : an
+// Aho-Corasick automaton of them tells, after each move of a path, whether the path now ends with one of them.
+// The longest ones are only compared to shorter ones, the sequences of the same length would take most of
+// the time and memory of the build for few more rules. The inverse move, and the 12 moves that turn 3 tiles
+// around a 2x2 square back in place, are among them. There is one automaton per size, built the first time
+// it is used, from the sequences that fit on the board only : few of them on the small ones.
+// A* only skips the sequences that have a strictly shorter equivalent : one of the same length could be
+// the only way it reached a state, because of its closed list. Depth first searches skip all of them.
+class MovePruning {
+  public:
+    static const size_t MAX_LENGTH = 12;
+    static const uint32_t START = 0; // state before any move
+
+    enum rules_e {
+        SHORTER = 1, // sequences with a strictly shorter equivalent
+        SAME_LENGTH = 2, // sequences with an equivalent as long, first in the order of the directions
+        ALL = 3
+    };
+
+    static const MovePruning& get(size_t size) {
+        static std::mutex lock;
+        static std::map<size_t, std::unique_ptr<MovePruning> > automata;
+        std::lock_guard<std::mutex> guard(lock);
+        auto& pruning = automata[std::min<size_t>(size, WIDTH)];
+
+        if (!pruning)
+            pruning.reset(new MovePruning(std::min<size_t>(size, WIDTH)));
+        return *pruning;
+    }
+
+    uint32_t next(uint32_t state, GameState::Direction move) const {
+        return _next[state][move];
+    }
+
+    // whether the path that led to state ends with a useless sequence of these rules
+    bool pruned(uint32_t state, rules_e rules) const {
+        return _pruned[state] & rules;
+    }
+
+    size_t states() const {
+        return _next.size();
+    }
+
+  private:
+    static const int WIDTH = 2 * MAX_LENGTH + 1; // of the grid, the empty box starts in the middle
+    static const size_t SLOTS = 1 << 10; // first size of the table of the sequences kept, doubled when 2/3 full
+    static const size_t MAX_PROBES = 64; // the table is doubled too when a search goes further
+
+    struct Box { // boxes gone through by a sequence
+        int8_t min_x, min_y, max_x, max_y;
+
+        bool inside(const Box& rhs) const {
+            return min_x >= rhs.min_x && min_y >= rhs.min_y && max_x <= rhs.max_x && max_y <= rhs.max_y;
+        }
+    };
+
+    struct Effect { // hashes of the tile on each box, 88 bits so that two effects never mix up
+        uint64_t    low;
+        uint32_t    high : 24;
+    };
+
+    struct Sequence { // the first ones found for an effect, in an open addressing table where they follow each other
+        uint64_t    low;
+        uint32_t    high : 24;
+        uint32_t    length : 8; // NONE for an empty slot
+        Box         box;
+
+        bool has(const Effect& effect) const {
+            return low == effect.low && high == effect.high;
+        }
+    };
+
+    static const uint8_t NONE = 0xff;
+    static const size_t NOT_KEPT = ~(size_t)0;
+
+    MovePruning(size_t size) : _size(size), _grid(WIDTH * WIDTH), _sequences(SLOTS, Sequence{0, 0, NONE, Box{0, 0, 0, 0}}), _stored(0) {
+        std::vector<std::pair<std::string, rules_e> > useless;
+
+        _effect = Effect{0, 0};
+        for (int i = 0; i < WIDTH * WIDTH; i++) {
+            _grid[i] = i;
+            toggle(i);
+        }
+        _empty = GameState::Point(MAX_LENGTH, MAX_LENGTH);
+        Box none = {(int8_t)_empty.x, (int8_t)_empty.y, (int8_t)_empty.x, (int8_t)_empty.y};
+        store(lookup(none), Sequence{_effect.low, _effect.high, 0, none});
+        for (size_t length = 1; length <= MAX_LENGTH; length++) { // the sequences found are only used by longer ones
+            build(useless);
+            enumerate(length, none, START, useless);
+        }
+        build(useless);
+        std::vector<Sequence>().swap(_sequences);
+    }
+
+    // plays every sequence of length moves that contains no useless sequence of the automaton, in the order
+    // of the directions, and records the ones that do the same as a sequence found before them
+    void enumerate(size_t length, const Box& box, uint32_t state, std::vector<std::pair<std::string, rules_e> >& useless) {
+        if (_moves.size() == length) {
+            size_t slot = lookup(box);
+            if (_sequences[slot].length != NONE)
+                useless.push_back(std::make_pair(_moves, _sequences[slot].length < length ? SHORTER : SAME_LENGTH));
+            else if (length < MAX_LENGTH)
+                store(slot, Sequence{_effect.low, _effect.high, (uint32_t)length, box});
+            return;
+        }
+        for (auto& move : GameState::directions) {
+            GameState::Point neighbor = _empty + move.second;
+            uint32_t next = _next[state][move.first];
+            if (!neighbor.in_bounds(WIDTH) || _pruned[next])
+                continue;
+            Box bigger = {(int8_t)std::min<int>(box.min_x, neighbor.x), (int8_t)std::min<int>(box.min_y, neighbor.y),
+                          (int8_t)std::max<int>(box.max_x, neighbor.x), (int8_t)std::max<int>(box.max_y, neighbor.y)};
+            if (bigger.max_x - bigger.min_x >= (int)_size || bigger.max_y - bigger.min_y >= (int)_size)
+                continue; // never played on this board
+            GameState::Point previous = _empty;
+            Effect effect = _effect;
+            _moves.push_back('0' + move.first);
+            swap(neighbor);
+            enumerate(length, bigger, next, useless);
+            std::swap(_grid[previous.y * WIDTH + previous.x], _grid[neighbor.y * WIDTH + neighbor.x]);
+            _empty = previous;
+            _effect = effect;
+            _moves.pop_back();
+        }
+    }
+
+    // slot of the shortest sequence kept with the effect played that stays inside box, or else of a free
+    // slot for the effect
+    size_t lookup(const Box& box) {
+        while (true) {
+            size_t mask = _sequences.size() - 1;
+            size_t found = NOT_KEPT;
+            size_t slot = _effect.low & mask;
+            for (size_t probe = 0; probe < MAX_PROBES; probe++, slot = (slot + 1) & mask) {
+                const Sequence& sequence = _sequences[slot];
+                if (sequence.length == NONE)
+                    return found != NOT_KEPT ? found : slot;
+                if (sequence.has(_effect) && sequence.box.inside(box) && (found == NOT_KEPT || sequence.length < _sequences[found].length))
+                    found = slot;
+            }
+            grow();
+        }
+    }
+
+    void store(size_t slot, const Sequence& sequence) {
+        _sequences[slot] = sequence;
+        if (++_stored * 3 > _sequences.size() * 2)
+            grow();
+    }
+
+    void grow() {
+        std::vector<Sequence> sequences(_sequences.size() * 2, Sequence{0, 0, NONE, Box{0, 0, 0, 0}});
+        size_t mask = sequences.size() - 1;
+
+        for (auto& sequence : _sequences) {
+            if (sequence.length == NONE)
+                continue;
+            size_t slot = sequence.low & mask;
+            while (sequences[slot].length != NONE)
+                slot = (slot + 1) & mask;
+            sequences[slot] = sequence;
+        }
+        _sequences.swap(sequences);
+    }
+
+    void swap(const GameState::Point& neighbor) {
+        int from = neighbor.y * WIDTH + neighbor.x;
+        int to = _empty.y * WIDTH + _empty.x;
+
+        toggle(from);
+        toggle(to);
+        std::swap(_grid[from], _grid[to]);
+        toggle(from);
+        toggle(to);
+        _empty = neighbor;
+    }
+
+    // adds or removes the tile on box from the hashes of the grid (splitmix64 of both)
+    void toggle(int box) {
+        uint64_t key = (uint64_t)box << 32 | _grid[box];
+
+        _effect.low ^= mix(key + 0x9e3779b97f4a7c15ULL);
+        _effect.high ^= mix(key + 0x632be59bd9b4e019ULL) & 0xffffff;
+    }
+
+    static uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // trie of the useless sequences, with the moves that fail in it going to the longest suffix it has
+    void build(const std::vector<std::pair<std::string, rules_e> >& useless) {
+        std::vector<uint32_t> fail(1, START);
+        std::deque<uint32_t> queue;
+
+        _next.assign(1, {{0, 0, 0, 0}});
+        _pruned.assign(1, 0);
+        for (auto& sequence : useless) {
+            uint32_t state = START;
+            for (char c : sequence.first) {
+                if (_next[state][c - '0'] == START) {
+                    _next[state][c - '0'] = _next.size();
+                    _next.push_back({{0, 0, 0, 0}});
+                    _pruned.push_back(0);
+                    fail.push_back(START);
+                }
+                state = _next[state][c - '0'];
+            }
+            _pruned[state] |= sequence.second;
+        }
+        for (size_t move = 0; move < 4; move++)
+            if (_next[START][move] != START)
+                queue.push_back(_next[START][move]);
+        while (!queue.empty()) { // by depth, the suffix of a state is done before it
+            uint32_t state = queue.front();
+            queue.pop_front();
+            _pruned[state] |= _pruned[fail[state]];
+            for (size_t move = 0; move < 4; move++) {
+                uint32_t& next = _next[state][move];
+                if (next == START) {
+                    next = _next[fail[state]][move];
+                    continue;
+                }
+                fail[next] = _next[fail[state]][move];
+                queue.push_back(next);
+            }
+        }
+    }
+
+    size_t                                                              _size; // of the boards
+    std::vector<int>                                                    _grid;
+    GameState::Point                                                    _empty;
+    std::string                                                         _moves; // sequence played, one digit per direction
+    Effect                                                              _effect; // of the sequence played
+    std::vector<Sequence>                                               _sequences;
+    size_t                                                              _stored; // sequences in the table
+    std::vector<std::array<uint32_t, 4> >                               _next;
+    std::vector<uint8_t>                                                _pruned;
+};
+
+const uint32_t MovePruning::START;
+const uint8_t MovePruning::NONE;
+const size_t MovePruning::NOT_KEPT;
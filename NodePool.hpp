@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Arena.hpp"
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+// Storage for the states of an open list, referred to by 32 bits handles so that the queue only moves integers.
+// Slots of released states are reused, and storing a state never moves the others (references stay valid).
+template <typename T>
+class NodePool {
+  public:
+    uint32_t store(T&& value) {
+        if (_free.empty())
+            return _nodes.push(std::move(value));
+        uint32_t handle = _free.back();
+        _free.pop_back();
+        _nodes[handle] = std::move(value);
+        return handle;
+    }
+
+    void release(uint32_t handle) {
+        _free.push_back(handle);
+    }
+
+    T& operator[](uint32_t handle) {
+        return _nodes[handle];
+    }
+
+    size_t size() const { // states currently stored
+        return _nodes.size() - _free.size();
+    }
+
+  private:
+    Arena<T>                _nodes;
+    std::vector<uint32_t>   _free;
+};
@@ -0,0 +1,265 @@
+#pragma once
+
+#include "GameState.hpp"
+#include "Generators.hpp"
+#include "BucketQueue.hpp"
+#include "NodePool.hpp"
+#include "ClosedList.hpp"
+#include "Deadline.hpp"
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <limits>
+
+// Hash distributed A* : every state belongs to the thread given by its hash, which keeps it in its own
+// open and closed lists. Generated children are batched per owner and handed over through the owner's inbox.
+// A thread that finds the solution only lowers the shared incumbent : the search ends when every thread
+// is out of states under the incumbent and no batch is in flight, which proves the incumbent is optimal.
+// The solution is also an incumbent as soon as it is generated, to bound the others early. Before that,
+// a thread only knows its own open list and expands states above the shortest solution that A* would
+// never reach, more of them on small boards and with more threads.
+class ParallelAStar {
+  public:
+    ParallelAStar(const GameState& initial, const GameState& solution, const heuristic_t& heuristic, size_t threads):
+        _initial(initial),
+        _solution(solution),
+        _heuristic(heuristic),
+        _incumbent(NOT_FOUND),
+        _sent(0),
+        _received(0),
+        _idle(0),
+        _done(false)
+    {
+        for (size_t i = 0; i < threads; i++)
+            _workers.emplace_back(new Worker(threads, heuristic.memory / threads));
+    }
+
+    Solution solve() {
+        std::vector<std::thread> threads;
+        GameState initial(_initial);
+
+        initial.setHeuristicScore(_heuristic.full(initial, _solution));
+        consider(owner(initial.key()), initial, GameState::RIGHT);
+        for (size_t i = 0; i < _workers.size(); i++)
+            threads.emplace_back(&ParallelAStar::run, this, i, Deadline::at());
+        for (auto& thread : threads)
+            thread.join();
+        if (_error)
+            std::rethrow_exception(_error);
+        if (_incumbent == NOT_FOUND)
+            return Solution();
+        return constructSolution();
+    }
+
+    size_t totalStates() const {
+        size_t total = 0;
+        for (auto& worker : _workers)
+            total += worker->total_states;
+        return total;
+    }
+
+    size_t maxRessource() const {
+        size_t total = 0;
+        for (auto& worker : _workers)
+            total += worker->max_ressource;
+        return total;
+    }
+
+  private:
+    static const size_t BATCH = 64;
+    static const size_t NOT_FOUND = std::numeric_limits<size_t>::max();
+
+    struct Record {
+        size_t                  depth;
+        GameState::Direction    move; // last move of the best known path, to rebuild the solution
+    };
+
+    struct Message {
+        GameState               state;
+        GameState::Direction    move;
+    };
+
+    struct Worker {
+        Worker(size_t threads, size_t memory): closed(memory), outgoing(threads), pending(false), total_states(0), max_ressource(0) {}
+
+        BucketQueue<uint32_t>                           open; // handles of the states in nodes
+        NodePool<GameState>                             nodes;
+        ClosedList<Record>                              closed;
+        std::vector<std::vector<Message> >              outgoing; // batches waiting to be sent, per owner
+        std::mutex                                      inbox_lock;
+        std::vector<Message>                            inbox;
+        std::atomic<bool>                               pending;
+        size_t                                          total_states;
+        size_t                                          max_ressource;
+    };
+
+    size_t ownerId(const Board& key) const { // middle bits, the low ones pick the closed list slot and the high ones its tag
+        return (key.hash() >> 32) % _workers.size();
+    }
+
+    Worker& owner(const Board& key) {
+        return *_workers[ownerId(key)];
+    }
+
+    void run(size_t id, std::chrono::steady_clock::time_point deadline) {
+        Worker& worker = *_workers[id];
+
+        Deadline::set(deadline);
+        try {
+            while (!_done) {
+                if (worker.pending)
+                    receive(worker);
+                if (!worker.open.empty() && worker.open.topF() < _incumbent) {
+                    expand(worker);
+                    continue;
+                }
+                for (size_t i = 0; i < worker.outgoing.size(); i++)
+                    flush(worker, i);
+                if (idle(worker))
+                    return;
+            }
+        } catch (...) { // the others stop too, the first error is thrown once they are joined
+            std::lock_guard<std::mutex> lock(_idle_lock);
+            if (!_error)
+                _error = std::current_exception();
+            _done = true;
+            _wake.notify_all();
+        }
+    }
+
+    void expand(Worker& worker) {
+        uint32_t handle = worker.open.pop();
+        GameState& current = worker.nodes[handle];
+        if (worker.closed.at(current.key()).depth < current.getDepth() // a shorter path was found since
+            || current == _solution) {
+            if (current == _solution)
+                improve(current.getFScore());
+            worker.nodes.release(handle);
+            return;
+        }
+        for (auto& move : current.directions) {
+            if (current.isRedundant(move.second))
+                continue ;
+            GameState::Point neighbor = current.neighbor(move.first);
+            if (!neighbor.in_bounds(current.size()))
+                continue;
+            GameState next(current);
+            next.setHeuristicScore(next.getHeuristicScore() + _heuristic.update(next, _solution, neighbor));
+            next.swap(neighbor);
+            if (next.getFScore() >= _incumbent)
+                continue;
+            next.setRedondant(move.second * -1);
+            size_t dest = ownerId(next.key());
+            if (next == _solution) // bounds the other threads at once, it is kept as any state until it is proven the shortest
+                improve(next.getFScore());
+            if (_workers[dest].get() == &worker)
+                consider(worker, next, move.first);
+            else {
+                worker.outgoing[dest].push_back(Message{std::move(next), move.first});
+                if (worker.outgoing[dest].size() >= BATCH)
+                    flush(worker, dest);
+            }
+        }
+        worker.nodes.release(handle);
+        if (worker.open.size() + worker.closed.size() > worker.max_ressource)
+            worker.max_ressource = worker.open.size() + worker.closed.size();
+        worker.total_states++;
+        Deadline::check(worker.total_states);
+    }
+
+    void improve(size_t f) {
+        size_t incumbent = _incumbent;
+        while (f < incumbent && !_incumbent.compare_exchange_weak(incumbent, f))
+            ;
+    }
+
+    // keeps the state if it is new or reached by a shorter path
+    void consider(Worker& worker, GameState& state, GameState::Direction move) {
+        auto record = worker.closed.insert(state.key(), Record{state.getDepth(), move});
+        if (!record.second && record.first->depth > state.getDepth())
+            *record.first = Record{state.getDepth(), move};
+        else if (!record.second)
+            return;
+        worker.open.push(state.getFScore(), state.getHeuristicScore(), worker.nodes.store(std::move(state)));
+    }
+
+    void receive(Worker& worker) {
+        std::vector<Message> messages;
+        {
+            std::lock_guard<std::mutex> lock(worker.inbox_lock);
+            messages.swap(worker.inbox);
+            worker.pending = false;
+        }
+        _received += messages.size();
+        for (auto& message : messages)
+            consider(worker, message.state, message.move);
+    }
+
+    void flush(Worker& worker, size_t id) {
+        std::vector<Message>& batch = worker.outgoing[id];
+        Worker& dest = *_workers[id];
+
+        if (batch.empty())
+            return;
+        _sent += batch.size();
+        {
+            std::lock_guard<std::mutex> lock(dest.inbox_lock);
+            dest.inbox.insert(dest.inbox.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+            dest.pending = true;
+        }
+        batch.clear();
+        {
+            std::lock_guard<std::mutex> lock(_idle_lock); // an idle owner can't miss the notification
+        }
+        _wake.notify_all();
+    }
+
+    // waits for a batch, returns true when the search is over
+    bool idle(Worker& worker) {
+        std::unique_lock<std::mutex> lock(_idle_lock);
+
+        if (worker.pending)
+            return false;
+        if (++_idle == _workers.size() && _sent == _received) {
+            _done = true;
+            _wake.notify_all();
+            return true;
+        }
+        _wake.wait(lock, [&] { return _done || worker.pending; });
+        if (_done)
+            return true;
+        --_idle;
+        return false;
+    }
+
+    Solution constructSolution() {
+        GameState current(_solution);
+        Solution solution;
+
+        while (current != _initial) { // recorded depths only decrease, so this always gets back to the start
+            GameState::Direction d = owner(current.key()).closed.at(current.key()).move;
+            GameState::Point neighbor = current.neighbor(GameState::opposite(d));
+            current.swap(neighbor);
+            solution.push_back(d);
+        }
+        solution.reverse();
+        return solution;
+    }
+
+    const GameState&                        _initial;
+    const GameState&                        _solution;
+    const heuristic_t&                      _heuristic;
+    std::vector<std::unique_ptr<Worker> >   _workers;
+    std::atomic<size_t>                     _incumbent; // f of the best solution found so far
+    std::atomic<size_t>                     _sent;
+    std::atomic<size_t>                     _received;
+    std::mutex                              _idle_lock;
+    std::condition_variable                 _wake;
+    size_t                                  _idle;
+    std::atomic<bool>                       _done; // also set by the first thread that fails
+    std::exception_ptr                      _error;
+};
@@ -0,0 +1,320 @@
+#pragma once
+
+#include "GameState.hpp"
+#include "Generators.hpp"
+#include "Deadline.hpp"
+#include "MovePruning.hpp"
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <limits>
+
+// Parallel iterative deepening A* : the threads are started once, and for each threshold the tree is expanded
+// breadth first until it has ITEMS subtrees per thread, dealt round robin to the threads. A thread searches its own subtrees in order,
+// then steals the last ones of the others. The subtrees are numbered in the order the sequential search
+// meets them : the first one that holds a solution cancels the ones after it and the ones before it are
+// searched to the end, so the solution is the one IDAStar finds, whatever the number of threads.
+class ParallelIDAStar {
+  public:
+    ParallelIDAStar(const GameState& initial, const GameState& solution, const heuristic_t& heuristic, size_t threads):
+        _initial(initial),
+        _solution(solution),
+        _heuristic(heuristic),
+        _pruning(MovePruning::get(initial.size())),
+        _round(0),
+        _busy(0),
+        _stopping(false),
+        _total_states(0),
+        _max_ressource(0),
+        _found(false)
+    {
+        for (size_t i = 0; i < threads; i++)
+            _workers.emplace_back(new Worker());
+    }
+
+    Solution solve() {
+        std::vector<std::thread> threads;
+        GameState root(_initial);
+        Solution solution;
+
+        for (size_t i = 1; i < _workers.size(); i++)
+            threads.emplace_back(&ParallelIDAStar::work, this, i, Deadline::at());
+        try {
+            root.setHeuristicScore(_heuristic.full(root, _solution));
+            size_t threshold = root.getHeuristicScore();
+            while (threshold != NOT_FOUND && !_found)
+                threshold = iterate(root, threshold);
+        } catch (...) {
+            stop(threads);
+            throw;
+        }
+        stop(threads);
+        for (auto move : _path)
+            solution.push_back(move);
+        return solution;
+    }
+
+    size_t totalStates() const {
+        size_t total = _total_states;
+        for (auto& worker : _workers)
+            total += worker->total_states;
+        return total;
+    }
+
+    size_t maxRessource() const {
+        size_t total = _max_ressource;
+        for (auto& worker : _workers)
+            total += worker->max_ressource;
+        return total;
+    }
+
+  private:
+    static const size_t ITEMS = 64; // subtrees per thread, enough for the big ones to be spread out
+    static const size_t FOUND = 0;
+    static const size_t CANCELLED = std::numeric_limits<size_t>::max() - 1;
+    static const size_t NOT_FOUND = std::numeric_limits<size_t>::max();
+
+    struct Item { // root of a subtree
+        GameState                           state;
+        uint32_t                            pruning;
+        std::vector<GameState::Direction>   path;
+    };
+
+    struct Worker {
+        std::mutex                          lock;
+        std::deque<size_t>                  items; // indexes in _items, its own first then the ones left to steal
+        std::vector<GameState::Direction>   path;
+        size_t                              next_threshold = NOT_FOUND;
+        size_t                              total_states = 0;
+        size_t                              max_ressource = 0;
+    };
+
+    // searches every subtree under threshold with the other threads, returns the next threshold
+    size_t iterate(const GameState& root, size_t threshold) {
+        size_t next_threshold = split(root, threshold);
+
+        _cutoff = _items.size();
+        for (size_t i = 0; i < _items.size(); i++)
+            _workers[i % _workers.size()]->items.push_back(i);
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _threshold = threshold;
+            _busy = _workers.size() - 1;
+            _round++;
+        }
+        _wake.notify_all();
+        run(0, threshold);
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            _idle.wait(lock, [this] { return _busy == 0; });
+        }
+        if (_error)
+            std::rethrow_exception(_error);
+        for (auto& worker : _workers) {
+            next_threshold = std::min(next_threshold, worker->next_threshold);
+            worker->next_threshold = NOT_FOUND;
+        }
+        return next_threshold;
+    }
+
+    // expands the tree level by level, in the order of the directions, into _items, returns the smallest f
+    // above threshold met on the way
+    size_t split(const GameState& root, size_t threshold) {
+        size_t next_threshold = NOT_FOUND;
+        bool deeper = true;
+
+        _items.assign(1, Item{root, MovePruning::START, {}});
+        while (deeper && _items.size() < ITEMS * _workers.size()) {
+            std::vector<Item> children;
+            deeper = false;
+            for (auto& item : _items) {
+                if (item.state == _solution) { // as the sequential search would, before the next subtrees
+                    children.push_back(std::move(item));
+                    continue;
+                }
+                deeper = true;
+                _total_states++;
+                Deadline::check(_total_states);
+                for (auto& move : GameState::directions) {
+                    uint32_t next = _pruning.next(item.pruning, move.first);
+                    if (_pruning.pruned(next, MovePruning::ALL))
+                        continue ;
+                    GameState::Point neighbor = item.state.neighbor(move.first);
+                    if (!neighbor.in_bounds(item.state.size()))
+                        continue;
+                    Item child{item.state, next, item.path};
+                    child.state.setHeuristicScore(child.state.getHeuristicScore() + _heuristic.update(child.state, _solution, neighbor));
+                    child.state.swap(neighbor);
+                    if (f(child.state) > threshold) {
+                        next_threshold = std::min(next_threshold, f(child.state));
+                        continue;
+                    }
+                    child.path.push_back(move.first);
+                    children.push_back(std::move(child));
+                }
+            }
+            if (_items.size() + children.size() > _max_ressource)
+                _max_ressource = _items.size() + children.size();
+            _items.swap(children);
+        }
+        return next_threshold;
+    }
+
+    // a thread other than the calling one : searches its subtrees each time a threshold starts
+    void work(size_t id, std::chrono::steady_clock::time_point deadline) {
+        size_t round = 0;
+
+        Deadline::set(deadline);
+        while (true) {
+            size_t threshold;
+            {
+                std::unique_lock<std::mutex> lock(_lock);
+                _wake.wait(lock, [this, round] { return _round != round || _stopping; });
+                if (_stopping)
+                    return;
+                round = _round;
+                threshold = _threshold;
+            }
+            run(id, threshold);
+            std::lock_guard<std::mutex> lock(_lock);
+            if (--_busy == 0)
+                _idle.notify_one();
+        }
+    }
+
+    void stop(std::vector<std::thread>& threads) {
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    void run(size_t id, size_t threshold) {
+        Worker& worker = *_workers[id];
+        size_t index;
+
+        try {
+            while (take(id, index)) {
+                if (index >= _cutoff)
+                    continue;
+                GameState current(_items[index].state);
+                worker.path.clear();
+                size_t t = search(worker, current, threshold, _items[index].pruning, index);
+                if (t == FOUND)
+                    found(worker, index);
+                else if (t != CANCELLED)
+                    worker.next_threshold = std::min(worker.next_threshold, t);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(_lock);
+            if (!_error)
+                _error = std::current_exception();
+            _cutoff = 0; // the others stop too
+        }
+    }
+
+    // its next subtree, or the last one of another thread
+    bool take(size_t id, size_t& index) {
+        for (size_t i = 0; i < _workers.size(); i++) {
+            Worker& victim = *_workers[(id + i) % _workers.size()];
+            std::lock_guard<std::mutex> lock(victim.lock);
+            if (victim.items.empty())
+                continue;
+            if (i == 0) {
+                index = victim.items.front();
+                victim.items.pop_front();
+            } else {
+                index = victim.items.back();
+                victim.items.pop_back();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // keeps the solution of the first subtree that has one
+    void found(const Worker& worker, size_t index) {
+        std::lock_guard<std::mutex> lock(_lock);
+
+        if (index >= _cutoff)
+            return;
+        _cutoff = index + 1;
+        _found = true;
+        _path = _items[index].path;
+        _path.insert(_path.end(), worker.path.begin(), worker.path.end());
+    }
+
+    // returns FOUND, CANCELLED once a subtree before this one has a solution, or the smallest f above
+    // threshold met in this subtree
+    size_t search(Worker& worker, GameState& current, size_t threshold, uint32_t pruning, size_t index) {
+        size_t next_threshold = NOT_FOUND;
+
+        if (f(current) > threshold)
+            return f(current);
+        if (current == _solution)
+            return FOUND;
+        if (index >= _cutoff.load(std::memory_order_relaxed))
+            return CANCELLED;
+        worker.total_states++;
+        Deadline::check(worker.total_states);
+        if (worker.path.size() + 1 > worker.max_ressource)
+            worker.max_ressource = worker.path.size() + 1;
+        for (auto& move : GameState::directions) {
+            uint32_t next = _pruning.next(pruning, move.first);
+            if (_pruning.pruned(next, MovePruning::ALL))
+                continue ;
+            GameState::Point neighbor = current.neighbor(move.first);
+            if (!neighbor.in_bounds(current.size()))
+                continue;
+            GameState::Point previous = current.zero();
+            size_t score = current.getHeuristicScore();
+            uint64_t keys = current.getHeuristicKeys();
+            current.setHeuristicScore(score + _heuristic.update(current, _solution, neighbor));
+            current.swap(neighbor);
+            worker.path.push_back(move.first);
+            size_t t = search(worker, current, threshold, next, index);
+            if (t == FOUND || t == CANCELLED)
+                return t;
+            worker.path.pop_back();
+            current.unswap(previous);
+            current.setHeuristicScore(score);
+            current.setHeuristicKeys(keys);
+            if (t < next_threshold)
+                next_threshold = t;
+        }
+        return next_threshold;
+    }
+
+    // not weighted, as in IDAStar
+    static size_t f(const GameState& state) {
+        return state.getDepth() + state.getHeuristicScore();
+    }
+
+    const GameState&                        _initial;
+    const GameState&                        _solution;
+    const heuristic_t&                      _heuristic;
+    const MovePruning&                      _pruning;
+    std::vector<std::unique_ptr<Worker> >   _workers;
+    std::vector<Item>                       _items; // subtrees of the current threshold
+    std::atomic<size_t>                     _cutoff; // subtrees from this one on are cancelled
+    std::mutex                              _lock;
+    std::condition_variable                 _wake; // the other threads wait there for the next threshold
+    std::condition_variable                 _idle; // and the calling one for them to be done with it
+    size_t                                  _round; // thresholds started
+    size_t                                  _threshold;
+    size_t                                  _busy; // other threads still searching the current threshold
+    bool                                    _stopping;
+    std::exception_ptr                      _error; // of the first thread that failed
+    size_t                                  _total_states; // while splitting
+    size_t                                  _max_ressource;
+    bool                                    _found;
+    std::vector<GameState::Direction>       _path;
+};
@@ -0,0 +1,352 @@
+#pragma once
+
+#include "GameState.hpp"
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Additive disjoint pattern databases.
+// The tiles are split into groups of consecutive values of the snail solution (6-6-3 on a 4x4 for example).
+// For each group, a table gives the number of moves of the group's tiles needed to bring them to their
+// solution position, whatever the other tiles are : the moves of the other tiles are free, so the values
+// of the groups can be added and the sum stays admissible.
+// The tables are computed once with a breadth first search from the solution, written to a file,
+// and the file is mmapped by later runs.
+class PatternDatabase {
+  public:
+    static const size_t MAX_SIZE = 8; // positions are stored in a 64 bits mask
+
+    PatternDatabase(const std::vector<int>& solution, const std::string& groups, const std::string& path) :
+        _solution(solution),
+        _size(std::sqrt(solution.size())),
+        _cells(solution.size()),
+        _map(MAP_FAILED),
+        _mapSize(0)
+    {
+        if (_size > MAX_SIZE)
+            throw std::invalid_argument("Invalid Argument: Pattern databases are only available up to "
+                + std::to_string(MAX_SIZE) + "x" + std::to_string(MAX_SIZE));
+        setGroups(groups.size() ? groups : defaultGroups(_size));
+        _path = path.size() ? path : "n_puzzle_" + std::to_string(_size) + "x" + std::to_string(_size) + "_" + groupsName() + ".pdb";
+        _firstColumn = 0;
+        for (size_t y = 0; y < _size; y++)
+            _firstColumn |= 1ULL << (y * _size);
+        _lastColumn = _firstColumn << (_size - 1);
+        if (!map()) {
+            std::cerr << "Building pattern database " << _path << " ..." << std::endl;
+            save();
+            if (!map())
+                throw std::runtime_error("Can't load pattern database " + _path);
+        }
+    }
+
+    ~PatternDatabase() {
+        if (_map != MAP_FAILED)
+            munmap(_map, _mapSize);
+    }
+
+    static void load(const std::vector<int>& solution, const std::string& groups, const std::string& path) {
+        size_t size = std::sqrt(solution.size());
+        if (size <= MAX_SIZE && _databases[size] != nullptr)
+            return ;
+        PatternDatabase *database = new PatternDatabase(solution, groups, path);
+        _databases[size] = database;
+    }
+
+    static size_t pdb(const GameState &lhs, const GameState &) {
+        const PatternDatabase &database = get(lhs.size());
+        size_t total = 0;
+        for (size_t g = 0; g < database._groups.size(); g++)
+            total += database._tables[g][database.rank(lhs, g, 0, 0)];
+        return total;
+    }
+
+    static int updatePdb(GameState &lhs, const GameState &, const GameState::Point &neighbor) {
+        const PatternDatabase &database = get(lhs.size());
+        size_t tile = lhs[neighbor];
+        size_t g = database._groupOf[tile];
+        if (g == NO_GROUP)
+            return 0;
+        const uint8_t *table = database._tables[g];
+        return (int)table[database.rank(lhs, g, tile, lhs.getIndex(lhs.zero()))] - (int)table[database.rank(lhs, g, 0, 0)];
+    }
+
+  private:
+    static const uint8_t NO_GROUP = 0xff;
+    static const uint8_t UNSEEN = 0xff;
+    static constexpr char MAGIC[8] = {'N', 'P', 'U', 'Z', 'P', 'D', 'B', '1'};
+
+    struct Header {
+        char        magic[8];
+        uint32_t    size;
+        uint32_t    groups;
+    };
+
+    static const PatternDatabase& get(size_t size) {
+        if (size > MAX_SIZE || _databases[size] == nullptr)
+            throw std::invalid_argument("No pattern database loaded for this size");
+        return *_databases[size];
+    }
+
+    static std::string defaultGroups(size_t size) {
+        size_t tiles = size * size - 1;
+        size_t group = size == 3 ? 8 : size == 4 ? 6 : 5;
+        std::string groups;
+
+        while (tiles) {
+            size_t n = std::min(group, tiles);
+            groups += (groups.size() ? "-" : "") + std::to_string(n);
+            tiles -= n;
+        }
+        return groups;
+    }
+
+    void setGroups(const std::string& spec) {
+        size_t pos = 0;
+        size_t value = 1;
+
+        _groupOf.assign(_cells, NO_GROUP);
+        while (pos < spec.size()) {
+            size_t n = 0;
+            size_t len = 0;
+            try {
+                n = std::stoul(spec.substr(pos), &len);
+            } catch (std::exception &) {
+                throw std::invalid_argument("Invalid Argument: Pattern database groups should look like 6-6-3");
+            }
+            if (n == 0 || n > 9 || value + n > _cells)
+                throw std::invalid_argument("Invalid Argument: Pattern database groups must have 1 to 9 tiles and cover at most all tiles");
+            _groups.push_back(std::vector<int>());
+            for (size_t i = 0; i < n; i++, value++) {
+                _groups.back().push_back(value);
+                _groupOf[value] = _groups.size() - 1;
+            }
+            pos += len;
+            if (pos < spec.size() && spec[pos++] != '-')
+                throw std::invalid_argument("Invalid Argument: Pattern database groups should look like 6-6-3");
+        }
+    }
+
+    std::string groupsName() const {
+        std::string name;
+        for (auto& group : _groups)
+            name += (name.size() ? "-" : "") + std::to_string(group.size());
+        return name;
+    }
+
+    size_t entries(size_t tiles) const { // number of ways to place tiles on the board
+        size_t n = 1;
+        for (size_t i = 0; i < tiles; i++)
+            n *= _cells - i;
+        return n;
+    }
+
+    // index of the positions of the group's tiles, tile (if not 0) being moved to position
+    size_t rank(const GameState &state, size_t g, size_t tile, size_t position) const {
+        uint8_t positions[16];
+        const std::vector<int> &group = _groups[g];
+
+        for (size_t i = 0; i < group.size(); i++)
+            positions[i] = (size_t)group[i] == tile ? position : state.find(group[i]);
+        return rank(positions, group.size());
+    }
+
+    size_t rank(const uint8_t *positions, size_t tiles) const {
+        uint64_t used = 0;
+        size_t index = 0;
+
+        for (size_t i = 0; i < tiles; i++) {
+            index = index * (_cells - i) + positions[i] - __builtin_popcountll(used & ((1ULL << positions[i]) - 1));
+            used |= 1ULL << positions[i];
+        }
+        return index;
+    }
+
+    // cells reachable by the empty box from region without crossing a tile of free
+    uint64_t flood(uint64_t region, uint64_t free) const {
+        uint64_t next = region;
+        do {
+            region = next;
+            next = region | (region << _size) | (region >> _size)
+                 | ((region << 1) & ~_firstColumn) | ((region >> 1) & ~_lastColumn);
+            next &= free;
+        } while (next != region);
+        return region;
+    }
+
+    // breadth first search from the solution on (positions of the group's tiles, region of the empty box),
+    // only the moves of the group's tiles are counted
+    std::vector<uint8_t> build(size_t g) const {
+        const std::vector<int> &group = _groups[g];
+        size_t tiles = group.size();
+        uint64_t board = _cells == 64 ? ~0ULL : (1ULL << _cells) - 1;
+        std::vector<uint8_t> table(entries(tiles), UNSEEN);
+        std::vector<bool> visited(entries(tiles) * _cells, false);
+        std::vector<uint64_t> layer;
+        std::vector<uint64_t> next;
+        uint8_t positions[16];
+        uint64_t occupied = 0;
+        size_t blank = 0;
+
+        for (size_t i = 0; i < _cells; i++) {
+            if (_solution[i] == 0)
+                blank = i;
+            else if (_groupOf[_solution[i]] == g)
+                positions[std::find(group.begin(), group.end(), _solution[i]) - group.begin()] = i;
+        }
+        for (size_t i = 0; i < tiles; i++)
+            occupied |= 1ULL << positions[i];
+        uint64_t region = flood(1ULL << blank, board & ~occupied);
+        layer.push_back(pack(positions, tiles, __builtin_ctzll(region)));
+        visited[rank(positions, tiles) * _cells + __builtin_ctzll(region)] = true;
+        table[rank(positions, tiles)] = 0;
+        for (uint8_t depth = 1; layer.size(); depth++) {
+            next.clear();
+            for (uint64_t state : layer) {
+                size_t representative = unpack(state, positions, tiles);
+                occupied = 0;
+                for (size_t i = 0; i < tiles; i++)
+                    occupied |= 1ULL << positions[i];
+                region = flood(1ULL << representative, board & ~occupied);
+                for (size_t i = 0; i < tiles; i++) {
+                    uint8_t from = positions[i];
+                    uint64_t targets = region & (((1ULL << from) << _size) | ((1ULL << from) >> _size)
+                        | (((1ULL << from) << 1) & ~_firstColumn) | (((1ULL << from) >> 1) & ~_lastColumn));
+                    for (; targets; targets &= targets - 1) {
+                        positions[i] = __builtin_ctzll(targets);
+                        uint64_t moved = flood(1ULL << from, board & ~(occupied ^ (1ULL << from) ^ (1ULL << positions[i])));
+                        size_t index = rank(positions, tiles);
+                        size_t key = index * _cells + __builtin_ctzll(moved);
+                        if (!visited[key]) {
+                            visited[key] = true;
+                            if (table[index] == UNSEEN)
+                                table[index] = depth;
+                            next.push_back(pack(positions, tiles, __builtin_ctzll(moved)));
+                        }
+                    }
+                    positions[i] = from;
+                }
+            }
+            layer.swap(next);
+        }
+        return table;
+    }
+
+    static uint64_t pack(const uint8_t *positions, size_t tiles, size_t representative) {
+        uint64_t state = representative;
+        for (size_t i = 0; i < tiles; i++)
+            state |= (uint64_t)positions[i] << (6 * (i + 1));
+        return state;
+    }
+
+    static size_t unpack(uint64_t state, uint8_t *positions, size_t tiles) {
+        for (size_t i = 0; i < tiles; i++)
+            positions[i] = (state >> (6 * (i + 1))) & 0x3f;
+        return state & 0x3f;
+    }
+
+    size_t headerSize() const {
+        size_t size = sizeof(Header) + _groups.size() * sizeof(uint32_t) + _cells * sizeof(uint32_t);
+        return (size + 7) & ~(size_t)7;
+    }
+
+    void writeHeader(std::vector<char> &header) const {
+        Header h;
+        header.assign(headerSize(), 0);
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.size = _size;
+        h.groups = _groups.size();
+        std::memcpy(header.data(), &h, sizeof(h));
+        uint32_t *fields = reinterpret_cast<uint32_t *>(header.data() + sizeof(h));
+        for (auto& group : _groups)
+            *fields++ = group.size();
+        for (size_t i = 0; i < _cells; i++)
+            *fields++ = _solution[i];
+    }
+
+    // builds every table and writes them next to the header, through a temporary file so that
+    // a concurrent run never maps a half written database
+    void save() const {
+        std::vector<char> header;
+        std::string tmp = _path + "." + std::to_string(getpid());
+        writeHeader(header);
+        FILE *file = std::fopen(tmp.c_str(), "wb");
+        if (!file)
+            throw std::runtime_error("Can't create pattern database " + tmp + " : " + std::strerror(errno));
+        bool ok = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+        for (size_t g = 0; ok && g < _groups.size(); g++) {
+            std::vector<uint8_t> table = build(g);
+            ok = std::fwrite(table.data(), 1, table.size(), file) == table.size();
+        }
+        ok = (std::fclose(file) == 0) && ok;
+        if (!ok || std::rename(tmp.c_str(), _path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            throw std::runtime_error("Can't write pattern database " + _path + " : " + std::strerror(errno));
+        }
+    }
+
+    // maps the database file, returns false if it is missing or was built for other groups
+    bool map() {
+        std::vector<char> header;
+        struct stat st;
+        size_t total;
+
+        writeHeader(header);
+        total = header.size();
+        for (auto& group : _groups)
+            total += entries(group.size());
+        int fd = open(_path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size != total) {
+            close(fd);
+            return false;
+        }
+        _map = mmap(nullptr, total, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (_map == MAP_FAILED)
+            return false;
+        _mapSize = total;
+        if (std::memcmp(_map, header.data(), header.size()) != 0) {
+            munmap(_map, _mapSize);
+            _map = MAP_FAILED;
+            return false;
+        }
+        const uint8_t *table = static_cast<const uint8_t *>(_map) + header.size();
+        _tables.clear();
+        for (auto& group : _groups) {
+            _tables.push_back(table);
+            table += entries(group.size());
+        }
+        return true;
+    }
+
+    std::vector<int>                _solution;
+    size_t                          _size;
+    size_t                          _cells;
+    std::string                     _path;
+    std::vector<std::vector<int>>   _groups;
+    std::vector<uint8_t>            _groupOf; // group of each tile
+    std::vector<const uint8_t *>    _tables;
+    void                            *_map;
+    size_t                          _mapSize;
+    uint64_t                        _firstColumn;
+    uint64_t                        _lastColumn;
+
+    static PatternDatabase          *_databases[MAX_SIZE + 1];
+};
+
+constexpr char PatternDatabase::MAGIC[8];
+const uint8_t PatternDatabase::NO_GROUP;
+const uint8_t PatternDatabase::UNSEEN;
+PatternDatabase *PatternDatabase::_databases[PatternDatabase::MAX_SIZE + 1] = {};
@@ -2,127 +2,307 @@
 
 #include "GameState.hpp"
 #include "Generators.hpp"
-#include "RandomTable.hpp"
-#include <queue>
+#include "Deadline.hpp"
+#include "IDAStar.hpp"
+#include "ParallelAStar.hpp"
+#include "ParallelIDAStar.hpp"
+#include "BidirectionalAStar.hpp"
+#include "AnytimeAStar.hpp"
+#include "FrontierAStar.hpp"
+#include "SubgoalSolver.hpp"
+#include "BucketQueue.hpp"
+#include "NodePool.hpp"
+#include "SearchStats.hpp"
+#include "ClosedList.hpp"
+#include "BlockWriter.hpp"
+#include "MovePruning.hpp"
+#include "SolutionCache.hpp"
 #include <set>
 #include <iostream>
 #include <vector>
-#include <unordered_map>
 #include <utility>
-#include <queue>
-#include <list>
 #include <map>
-
-typedef std::list<GameState::Direction> Solution;
+#include <limits>
+#include <cmath>
+#include <sys/resource.h>
 
 class Puzzle {
   public:
     Puzzle(heuristic_t heuristic, const Data& data, const Data& solution):
         _size(std::sqrt(data.size())),
-        _table(RandomTable(_size)),
-        _initial(data, _size, _table),
-        _solution(solution, _size, _table),
+        _initial(data, _size),
+        _solution(solution, _size),
         _heuristic(heuristic),
         _total_states(0),
         _max_ressource(0)
-    {
-        GameState::_g = !heuristic.greedy;
-    }
+    {}
 
     Solution solve() {
-        std::priority_queue<GameState, std::vector<GameState>, std::greater<GameState> > queue;
-        GameState::Point last_move;
-        std::unordered_map< uint64_t, size_t > visited;
-
         if(!_initial.isSolvable()) {
             std::cout << _initial << "\nPuzzle is not solvable" << std::endl;
             return Solution();
         }
+        if (_heuristic.cache.empty())
+            return search();
+        SolutionCache& cache = SolutionCache::get(_heuristic.cache);
+        Solution solution;
+        if (cache.find(_initial.key(), solution))
+            return solution;
+        solution = search();
+        // only the shortest solutions are kept, an empty one is a search that failed unless already solved
+        if (!_heuristic.greedy && _heuristic.weight <= 1 && _heuristic.engine != SUBGOALS && (!solution.empty() || _initial == _solution))
+            cache.store(_initial.key(), solution);
+        return solution;
+    }
+
+    Solution search() {
+        BucketQueue<uint32_t> queue; // handles of the nodes, by f then h
+        NodePool<Node> nodes;
+        PathTree paths;
+        ClosedList<uint32_t> visited(_heuristic.memory); // best depth of each generated state
+
+        if (_heuristic.engine == IDASTAR)
+            return solveIDA();
+        if (_heuristic.engine == BIDIRECTIONAL)
+            return solveBidirectional();
+        if (_heuristic.engine == ARASTAR)
+            return solveAnytime();
+        if (_heuristic.engine == FRONTIER)
+            return solveFrontier();
+        if (_heuristic.engine == SUBGOALS)
+            return solveSubgoals();
+        if (_heuristic.threads > 1)
+            return solveParallel();
+        const MovePruning& pruning = MovePruning::get(_size); // not built for the engines above, most of them do without it
         _initial.setHeuristicScore(_heuristic.full(_initial, _solution));
-        queue.push(_initial); //calls copy constructor
+        _stats.detailed = true;
+        visited.insert(_initial.key(), 0);
+        queue.push(_initial.getFScore(), _initial.getHeuristicScore(),
+                   nodes.store(Node{GameState(_initial), paths.add(PathTree::ROOT, GameState::RIGHT), MovePruning::START}));
         while (!queue.empty()) {
-            GameState current(std::move(const_cast<GameState&>(queue.top()))); // hack to move out of priority_queue, safe because we pop just after
-            queue.pop();
+            size_t stored = queue.topF(); // f the node was queued with, above its own once partly expanded
+            uint32_t handle = TIMED(_stats.queue_seconds, queue.pop());
+            Node& node = nodes[handle]; // stays valid while children are stored
+            GameState& current = node.state;
             if (current == _solution) {
-                return constructSolution();
+                _stats.load_factor = visited.loadFactor();
+                return paths.solution(node.path);
+            }
+            if (*TIMED(_stats.hashing_seconds, visited.find(current.key())) < current.getDepth()) { // reached again by a shorter path since
+                nodes.release(handle);
+                continue;
             }
-            visited.insert(std::make_pair(current.hash(), current.getDepth()));
+            size_t later = NOT_FOUND; // lowest f of the children left for a next expansion of the node
             for (auto& move : current.directions) {
-                if (current.isRedundant(move.second))
+                uint32_t moves = pruning.next(node.pruning, move.first);
+                if (pruning.pruned(moves, MovePruning::SHORTER)) // a shorter path reaches the same state
                     continue ;
                 GameState::Point neighbor = current.neighbor(move.first);
                 if (!neighbor.in_bounds(_size))
                     continue;
                 GameState next(current);
-                next.setHeuristicScore(next.getHeuristicScore() + _heuristic.update(next, _solution, neighbor));
+                int delta = TIMED(_stats.heuristic_seconds, _heuristic.update(next, _solution, neighbor));
+                if (_heuristic.partial) { // only the children of the f the node was queued with are stored
+                    size_t f = (current.getHeuristicScore() + delta) * GameState::_hWeight + (current.getDepth() + 1) * GameState::_gWeight;
+                    if (f > stored) {
+                        later = std::min(later, f);
+                        continue;
+                    }
+                    if (f < stored && stored != current.getFScore()) // stored by an earlier expansion
+                        continue;
+                }
+                next.setHeuristicScore(next.getHeuristicScore() + delta);
                 next.swap(neighbor);
+                _stats.generations++;
                 // next.setHeuristicScore(_heuristic.full(next, _solution)); // old version of heuristic, not used anymore (not opti)
                 // std::cerr << next.getHeuristicScore() << std::endl;
-                auto already_visited = visited.find(next.hash());
-                if (already_visited == visited.end() || already_visited->second > next.getDepth() + 1) {
-                    if (already_visited != visited.end()) {
-                        already_visited->second = next.getDepth() + 1;
-                        _came_from[next.hash()] = move.first;
+                auto visit = TIMED(_stats.hashing_seconds, visited.insert(next.key(), next.getDepth()));
+                if (visit.second || *visit.first > next.getDepth()) {
+                    if (!visit.second) {
+                        *visit.first = next.getDepth();
+                        _stats.reopenings++;
                     }
-                    else
-                        _came_from.insert({next.hash(), move.first});
-                    next.setRedondant(move.second * -1);
-                    queue.push(std::move(next));
+                    TIMED(_stats.queue_seconds, queue.push(next.getFScore(), next.getHeuristicScore(),
+                          nodes.store(Node{std::move(next), paths.add(node.path, move.first), moves})));
                 }
+                else
+                    _stats.duplicates++;
             }
+            if (later != NOT_FOUND) // expanded again when its next f comes
+                queue.push(later, current.getHeuristicScore(), handle);
+            else
+                nodes.release(handle);
             if (queue.size() + visited.size() > _max_ressource)
                 _max_ressource = queue.size() + visited.size();
+            if (queue.size() > _stats.peak_open)
+                _stats.peak_open = queue.size();
+            if (visited.size() > _stats.peak_closed)
+                _stats.peak_closed = visited.size();
             _total_states++;
+            Deadline::check(_total_states);
+            _stats.sample(_total_states);
         }
         std::cout << _initial << "\nPuzzle is not solvable" << std::endl;
         return Solution();
     }
 
-    Solution constructSolution() {
-        GameState current(_solution);
-        std::map<GameState::Direction, GameState::Direction> reverse = {
-            {GameState::LEFT, GameState::RIGHT},
-            {GameState::RIGHT, GameState::LEFT},
-            {GameState::UP, GameState::DOWN},
-            {GameState::DOWN, GameState::UP}
-        };
-        Solution solution;
+    Solution solveIDA() {
+        if (_heuristic.threads > 1)
+            return solveParallelIDA();
+        IDAStar ida(_initial, _solution, _heuristic);
+        Solution solution = ida.solve();
 
-        while (current != _initial) {
-            GameState::Direction d = _came_from[current.hash()];
-            GameState::Point neighbor = current.neighbor(reverse[d]);
-            current.swap(neighbor);
-            solution.push_front(d);
-        }
+        _total_states = ida.totalStates();
+        _max_ressource = ida.maxRessource();
+        return solution;
+    }
+
+    Solution solveParallelIDA() {
+        ParallelIDAStar ida(_initial, _solution, _heuristic, _heuristic.threads);
+        Solution solution = ida.solve();
+
+        _total_states = ida.totalStates();
+        _max_ressource = ida.maxRessource();
+        return solution;
+    }
+
+    Solution solveBidirectional() {
+        BidirectionalAStar mm(_initial, _solution, _heuristic);
+        Solution solution = mm.solve();
+
+        _total_states = mm.totalStates();
+        _max_ressource = mm.maxRessource();
+        return solution;
+    }
+
+    Solution solveAnytime() {
+        AnytimeAStar ara(_initial, _solution, _heuristic);
+        Solution solution = ara.solve();
+
+        _total_states = ara.totalStates();
+        _max_ressource = ara.maxRessource();
+        return solution;
+    }
+
+    Solution solveFrontier() {
+        FrontierAStar frontier(_initial, _solution, _heuristic);
+        Solution solution = frontier.solve();
+
+        _total_states = frontier.totalStates();
+        _max_ressource = frontier.maxRessource();
+        return solution;
+    }
+
+    Solution solveSubgoals() {
+        SubgoalSolver subgoals(_initial, _solution);
+        Solution solution = subgoals.solve();
+
+        _total_states = subgoals.totalStates();
+        _max_ressource = subgoals.maxRessource();
+        return solution;
+    }
+
+    Solution solveParallel() {
+        ParallelAStar hda(_initial, _solution, _heuristic, _heuristic.threads);
+        Solution solution = hda.solve();
+
+        _total_states = hda.totalStates();
+        _max_ressource = hda.maxRessource();
         return solution;
     }
 
+    size_t totalStates() const {
+        return _total_states;
+    }
+
+    size_t maxRessource() const {
+        return _max_ressource;
+    }
+
+    // csv : moves, total states, max ressource, seconds, total states per second, peak memory in kB, on one line
+    // json : the same, plus the details of A* (null with the other engines) and the timers (null unless built with them)
+    void printStats(const Solution& sol, double seconds) const {
+        struct rusage usage;
+        size_t speed = seconds > 0 ? (size_t)(_total_states / seconds) : 0;
+
+        getrusage(RUSAGE_SELF, &usage);
+        if (_heuristic.stats == "csv") {
+            std::cout << sol.size() << ',' << _total_states << ',' << _max_ressource << ',' << seconds << ','
+                      << speed << ',' << usage.ru_maxrss << std::endl;
+            return;
+        }
+        std::cout << "{\"moves\":" << sol.size() << ",\"expansions\":" << _total_states
+                  << ",\"max_ressource\":" << _max_ressource << ",\"seconds\":" << seconds
+                  << ",\"nodes_per_second\":" << speed << ",\"peak_rss_kb\":" << usage.ru_maxrss;
+        if (_stats.detailed)
+            std::cout << ",\"generations\":" << _stats.generations << ",\"reopenings\":" << _stats.reopenings
+                      << ",\"duplicates\":" << _stats.duplicates << ",\"peak_open\":" << _stats.peak_open
+                      << ",\"peak_closed\":" << _stats.peak_closed << ",\"load_factor\":" << _stats.load_factor;
+        else
+            std::cout << ",\"generations\":null,\"reopenings\":null,\"duplicates\":null,\"peak_open\":null"
+                      << ",\"peak_closed\":null,\"load_factor\":null";
+        if (_stats.detailed && SearchStats::timed())
+            std::cout << ",\"timers\":{\"heuristic\":" << _stats.heuristic_seconds << ",\"hashing\":"
+                      << _stats.hashing_seconds << ",\"queue\":" << _stats.queue_seconds << "}";
+        else
+            std::cout << ",\"timers\":null";
+        std::cout << ",\"nodes_per_second_samples\":[";
+        for (size_t i = 0; i < _stats.speed_samples.size(); i++)
+            std::cout << (i ? "," : "") << _stats.speed_samples[i];
+        std::cout << "]}" << std::endl;
+    }
+
+    // prints the solution as chosen by the display option, through a single buffered writer
     void play(const Solution& sol) {
         GameState current(_initial);
         std::string osef;
+        BlockWriter writer;
+        std::ostream out(&writer);
 
-        std::cout << "Number of moves : " << sol.size() << std::endl;
-        std::cout << "Max ressource : " << _max_ressource << std::endl;
-        std::cout << "Total states : " << _total_states << std::endl;
-        for (size_t i = 0; i < current.size() + 2; i++)
-            std::cout << std::endl;
-        for (auto& move : sol) {
+        std::cout.flush(); // what was printed before the solution comes first
+        if (_heuristic.display == MOVES) {
+            out << sol.toString() << '\n';
+            return;
+        }
+        out << "Number of moves : " << sol.size() << '\n';
+        out << "Max ressource : " << _max_ressource << '\n';
+        out << "Total states : " << _total_states << '\n';
+        if (_heuristic.display == ALL_STATES)
+            out << '\n' << current;
+        else if (_heuristic.display == ANIMATE)
+            for (size_t i = 0; i < current.size() + 2; i++)
+                out << '\n';
+        for (auto move : sol) {
             auto neighbor = current.neighbor(move);
             current.swap(neighbor);
-            for (size_t i = 0; i < current.size() + 1; i++)    
-                std::cout << "\033[1A";
-            std::cout << current;
-            getline(std::cin, osef);
+            if (_heuristic.display == ALL_STATES)
+                out << '\n' << current;
+            else if (_heuristic.display == ANIMATE) {
+                for (size_t i = 0; i < current.size() + 1; i++)
+                    out << "\033[1A";
+                out << current;
+                out.flush();
+                getline(std::cin, osef);
+            }
         }
+        if (_heuristic.display == FINAL_STATE)
+            out << '\n' << current;
     }
 
   private:
+    static const size_t NOT_FOUND = std::numeric_limits<size_t>::max();
+
+    struct Node {
+        GameState   state;
+        uint32_t    path; // node of the path tree leading to the state
+        uint32_t    pruning; // state of the move pruning automaton after that path
+    };
+
     size_t                                              _size;
-    RandomTable                                         _table;
     GameState                                           _initial;
     GameState                                           _solution;
     heuristic_t                                         _heuristic;
     size_t                                              _total_states;
     size_t                                              _max_ressource;
-    std::unordered_map<uint64_t, GameState::Direction>  _came_from;
+    SearchStats                                         _stats;
 };
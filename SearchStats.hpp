@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <cstddef>
+
+// Time spent in the heuristic updates, closed list lookups and queue operations of A*, only measured
+// when built with -DN_PUZZLE_TIMERS (make CXXFLAGS+=-DN_PUZZLE_TIMERS) : otherwise TIMED(total, expression)
+// is just the expression, and no clock is read in the hot path.
+#ifdef N_PUZZLE_TIMERS
+# define TIMED(total, expression) ([&]() { SearchStats::Stopwatch watch(total); return expression; }())
+#else
+# define TIMED(total, expression) (expression)
+#endif
+
+struct SearchStats {
+    static const size_t SAMPLE_PERIOD = 1 << 16; // expansions between two samples of the speed
+
+    SearchStats():
+        detailed(false),
+        generations(0),
+        reopenings(0),
+        duplicates(0),
+        peak_open(0),
+        peak_closed(0),
+        load_factor(0),
+        heuristic_seconds(0),
+        hashing_seconds(0),
+        queue_seconds(0),
+        _last_expansions(0),
+        _last_sample(std::chrono::steady_clock::now())
+    {}
+
+    // adds the time it lives to a total
+    class Stopwatch {
+      public:
+        Stopwatch(double& total) : _total(total), _start(std::chrono::steady_clock::now()) {}
+        ~Stopwatch() {
+            _total += std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+        }
+
+      private:
+        double&                                 _total;
+        std::chrono::steady_clock::time_point   _start;
+    };
+
+    static bool timed() {
+#ifdef N_PUZZLE_TIMERS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // records the states per second since the last sample, every SAMPLE_PERIOD expansions
+    void sample(size_t expansions) {
+        if (expansions - _last_expansions < SAMPLE_PERIOD)
+            return;
+        auto now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - _last_sample).count();
+        if (seconds > 0)
+            speed_samples.push_back((expansions - _last_expansions) / seconds);
+        _last_expansions = expansions;
+        _last_sample = now;
+    }
+
+    bool                    detailed; // false if the engine only counts expansions and max ressource
+    size_t                  generations;
+    size_t                  reopenings; // states reached again by a shorter path
+    size_t                  duplicates; // states reached again by a path that is not shorter, pruned
+    size_t                  peak_open;
+    size_t                  peak_closed;
+    double                  load_factor; // of the closed list at the end
+    double                  heuristic_seconds;
+    double                  hashing_seconds;
+    double                  queue_seconds;
+    std::vector<size_t>     speed_samples; // states per second
+
+  private:
+    size_t                                  _last_expansions;
+    std::chrono::steady_clock::time_point   _last_sample;
+};
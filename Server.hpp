@@ -0,0 +1,290 @@
+#pragma once
+
+#include "Generators.hpp"
+#include "Puzzle.hpp"
+#include "Deadline.hpp"
+#include <sstream>
+#include <memory>
+#include <deque>
+#include <list>
+#include <map>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <future>
+#include <condition_variable>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Resident solver : reads puzzles from the clients of a Unix socket (or from the standard input with -),
+// one per line as the size then all the values, and answers each with one line, in the order of the
+// requests of that client :
+//   moves count, total states, max ressource, seconds and the moves (R, D, L, U)
+//   or "unsolvable", "timeout" past the time limit of a request, or "error" and the reason
+// The puzzles of all clients are solved by one pool of threads, each puzzle on a single thread. The goals
+// and heuristic tables of each size are built by the first request of that size and kept for the next ones,
+// the requests of the other sizes don't wait for them.
+class Server {
+  public:
+    static const int BACKLOG = 64;
+
+    Server(const heuristic_t& heuristic):
+        _heuristic(heuristic),
+        _workers(heuristic.threads),
+        _running(true)
+    {
+        _heuristic.threads = 1;
+    }
+
+    void run() {
+        std::vector<std::thread> threads;
+
+        std::signal(SIGPIPE, SIG_IGN); // a client leaving early is an error on its socket only
+        for (size_t i = 0; i < _workers; i++)
+            threads.emplace_back(&Server::work, this);
+        try {
+            if (_heuristic.serve == "-")
+                session(STDIN_FILENO, STDOUT_FILENO);
+            else
+                listen();
+        } catch (...) {
+            stop(threads);
+            throw;
+        }
+        stop(threads);
+    }
+
+  private:
+    // answers of a client not written yet, in the order of its requests
+    struct Answers {
+        std::mutex                              lock;
+        std::condition_variable                 ready;
+        std::deque<std::future<std::string> >   lines;
+        bool                                    reading = true;
+    };
+
+    struct Client {
+        int                                     socket;
+        std::thread                             thread;
+        std::atomic<bool>                       done{false};
+    };
+
+    struct Goal {
+        std::once_flag                          built;
+        std::shared_ptr<const Data>             data;
+    };
+
+    // lets the workers answer the requests left, then waits for them
+    void stop(std::vector<std::thread>& threads) {
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _running = false;
+        }
+        _has_tasks.notify_all();
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    // serves every client on its own thread, until the socket fails
+    void listen() {
+        struct sockaddr_un address;
+        std::list<std::unique_ptr<Client> > clients;
+        int server = socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (server < 0)
+            throw std::runtime_error(std::string("Can't create socket : ") + std::strerror(errno));
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (_heuristic.serve.size() >= sizeof(address.sun_path))
+            throw std::invalid_argument("Invalid Argument: The socket path is too long");
+        std::strcpy(address.sun_path, _heuristic.serve.c_str());
+        unlink(address.sun_path); // left by a previous server
+        if (bind(server, (struct sockaddr *)&address, sizeof(address)) != 0 || ::listen(server, BACKLOG) != 0) {
+            close(server);
+            throw std::runtime_error("Can't listen on " + _heuristic.serve + " : " + std::strerror(errno));
+        }
+        std::cerr << "Serving on " << _heuristic.serve << std::endl;
+        while (true) {
+            int client = accept(server, nullptr, nullptr);
+            if (client < 0 && errno == EINTR)
+                continue;
+            if (client < 0)
+                break;
+            leave(clients, false);
+            clients.emplace_back(new Client());
+            Client& added = *clients.back();
+            added.socket = client;
+            added.thread = std::thread([this, &added] {
+                session(added.socket, added.socket);
+                shutdown(added.socket, SHUT_RDWR); // the client sees the end of the answers, closed once joined
+                added.done = true;
+            });
+        }
+        std::string error = std::strerror(errno);
+        close(server);
+        leave(clients, true);
+        throw std::runtime_error("Can't accept clients : " + error);
+    }
+
+    // joins the sessions that are over, or all of them once they have their answers
+    void leave(std::list<std::unique_ptr<Client> >& clients, bool all) {
+        for (auto client = clients.begin(); client != clients.end(); ) {
+            if (!all && !(*client)->done) {
+                ++client;
+                continue;
+            }
+            shutdown((*client)->socket, SHUT_RD); // no more requests
+            (*client)->thread.join();
+            close((*client)->socket);
+            client = clients.erase(client);
+        }
+    }
+
+    // reads the requests of a client and hands them to the workers, its answers are written by another thread
+    void session(int in, int out) {
+        Answers answers;
+        std::thread writer(&Server::write, this, out, std::ref(answers));
+        std::string buffer;
+        char block[1 << 12];
+        ssize_t count;
+
+        while ((count = read(in, block, sizeof(block))) != 0) {
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count < 0)
+                break;
+            buffer.append(block, count);
+            size_t start = 0;
+            for (size_t end; (end = buffer.find('\n', start)) != std::string::npos; start = end + 1)
+                request(buffer.substr(start, end - start), answers);
+            buffer.erase(0, start);
+        }
+        request(buffer, answers);
+        {
+            std::lock_guard<std::mutex> lock(answers.lock);
+            answers.reading = false;
+        }
+        answers.ready.notify_one();
+        writer.join();
+    }
+
+    void request(const std::string& line, Answers& answers) {
+        size_t start = line.find_first_not_of(" \t\r");
+
+        if (start == std::string::npos || line[start] == '#')
+            return;
+        std::packaged_task<std::string()> task([this, line] { return solve(line); });
+        std::future<std::string> answer = task.get_future();
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _tasks.push_back(std::move(task));
+        }
+        _has_tasks.notify_one();
+        {
+            std::lock_guard<std::mutex> lock(answers.lock);
+            answers.lines.push_back(std::move(answer));
+        }
+        answers.ready.notify_one();
+    }
+
+    void write(int out, Answers& answers) {
+        bool open = true;
+
+        while (true) {
+            std::unique_lock<std::mutex> lock(answers.lock);
+            answers.ready.wait(lock, [&answers] { return !answers.lines.empty() || !answers.reading; });
+            if (answers.lines.empty())
+                return;
+            std::future<std::string> answer = std::move(answers.lines.front());
+            answers.lines.pop_front();
+            lock.unlock();
+            std::string line = answer.get() + '\n';
+            for (size_t done = 0; open && done < line.size(); ) { // the answers left are still awaited
+                ssize_t written = ::write(out, line.data() + done, line.size() - done);
+                if (written < 0 && errno == EINTR)
+                    continue;
+                open = written > 0;
+                done += open ? written : 0;
+            }
+        }
+    }
+
+    void work() {
+        std::packaged_task<std::string()> task;
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(_lock);
+                _has_tasks.wait(lock, [this] { return !_tasks.empty() || !_running; });
+                if (_tasks.empty())
+                    return;
+                task = std::move(_tasks.front());
+                _tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::string solve(const std::string& request) {
+        Generators::FileReader input(request.data(), request.data() + request.size());
+        std::ostringstream line;
+        Generators gen;
+        Data data;
+
+        try {
+            if (!gen.nextTable(input, data))
+                return "error Empty request";
+            if (!GameState(data, std::sqrt(data.size())).isSolvable())
+                return "unsolvable";
+            std::shared_ptr<const Data> goal = this->goal(gen, std::sqrt(data.size()));
+            Puzzle puzzle(_heuristic, data, *goal);
+            auto start = std::chrono::steady_clock::now();
+            Deadline::set(_heuristic.timeout);
+            Solution solution = puzzle.solve();
+            std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+            line << solution.size() << ' ' << puzzle.totalStates() << ' ' << puzzle.maxRessource()
+                 << ' ' << seconds.count() << ' ' << solution.toString();
+        } catch (Deadline::Expired &) {
+            return "timeout";
+        } catch (std::exception &e) {
+            return std::string("error ") + e.what();
+        }
+        return line.str();
+    }
+
+    // goal of the size of the last table read by gen, its heuristic tables are loaded with it
+    std::shared_ptr<const Data> goal(Generators& gen, size_t size) {
+        std::shared_ptr<Goal> goal;
+
+        {
+            std::lock_guard<std::mutex> lock(_goals_lock);
+            auto& entry = _goals[size];
+            if (!entry)
+                entry = std::make_shared<Goal>();
+            goal = entry;
+        }
+        std::call_once(goal->built, [this, &gen, &goal] { // the other requests of this size wait for it
+            Data solution = gen.generateSolution();
+            _heuristic.loadTables(solution);
+            goal->data = std::make_shared<const Data>(solution);
+        });
+        return goal->data;
+    }
+
+    heuristic_t                                             _heuristic;
+    size_t                                                  _workers;
+    std::mutex                                              _lock;
+    std::condition_variable                                 _has_tasks;
+    std::deque<std::packaged_task<std::string()> >          _tasks;
+    bool                                                    _running; // false once the standard input is read
+    std::mutex                                              _goals_lock;
+    std::map<size_t, std::shared_ptr<Goal> >                _goals;
+};
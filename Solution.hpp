@@ -0,0 +1,131 @@
+#pragma once
+
+#include "GameState.hpp"
+#include "Arena.hpp"
+#include <vector>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <stdexcept>
+
+// List of moves packed on 2 bits each.
+class Solution {
+  public:
+    class const_iterator {
+      public:
+        typedef std::forward_iterator_tag   iterator_category;
+        typedef GameState::Direction        value_type;
+        typedef std::ptrdiff_t              difference_type;
+        typedef const GameState::Direction* pointer;
+        typedef GameState::Direction        reference;
+
+        const_iterator(const Solution& solution, size_t index) : _solution(&solution), _index(index) {}
+
+        GameState::Direction operator*() const {
+            return (*_solution)[_index];
+        }
+
+        const_iterator& operator++() {
+            ++_index;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator tmp(*this);
+            ++_index;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator& rhs) const {
+            return _index == rhs._index;
+        }
+
+        bool operator!=(const const_iterator& rhs) const {
+            return _index != rhs._index;
+        }
+
+      private:
+        const Solution  *_solution;
+        size_t          _index;
+    };
+
+    Solution() : _size(0) {}
+
+    void push_back(GameState::Direction move) {
+        if ((_size & 31) == 0)
+            _moves.push_back(0);
+        _moves.back() |= (uint64_t)move << ((_size & 31) * 2);
+        _size++;
+    }
+
+    GameState::Direction operator[](size_t index) const {
+        return (GameState::Direction)((_moves[index >> 5] >> ((index & 31) * 2)) & 3);
+    }
+
+    void reverse() {
+        Solution reversed;
+        for (size_t i = _size; i > 0; i--)
+            reversed.push_back((*this)[i - 1]);
+        *this = reversed;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    std::string toString() const { // one letter per move of the empty box : R, D, L or U
+        std::string moves(_size, ' ');
+        for (size_t i = 0; i < _size; i++)
+            moves[i] = "RDLU"[(*this)[i]];
+        return moves;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    const_iterator begin() const {
+        return const_iterator(*this, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(*this, _size);
+    }
+
+  private:
+    std::vector<uint64_t>   _moves;
+    size_t                  _size;
+};
+
+// Tree of the paths explored by a search : each node only knows its parent and the move that leads to it.
+class PathTree {
+  public:
+    static const uint32_t ROOT = (1u << 30) - 1; // parent of the initial state, and the most nodes kept
+
+    uint32_t add(uint32_t parent, GameState::Direction move) {
+        if (_nodes.size() >= ROOT) // the index of the next node wouldn't fit in the parent of its children
+            throw std::runtime_error("Too many states for the paths of the search (" + std::to_string(ROOT) + ")");
+        return _nodes.push(Node{parent, (uint32_t)move});
+    }
+
+    Solution solution(uint32_t node) const { // moves from the initial state to node
+        Solution solution;
+        for (; node != ROOT; node = _nodes[node].parent)
+            if (_nodes[node].parent != ROOT)
+                solution.push_back((GameState::Direction)_nodes[node].move);
+        solution.reverse();
+        return solution;
+    }
+
+    size_t size() const {
+        return _nodes.size();
+    }
+
+  private:
+    struct Node {
+        uint32_t parent : 30;
+        uint32_t move : 2;
+    };
+
+    Arena<Node> _nodes;
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "Board.hpp"
+#include "Solution.hpp"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Shortest solutions of the boards already solved, in a file mapped by every run that uses it.
+// The file is an open addressing table of fixed size slots : the control word of a slot (0 if empty, the
+// pid of its writer while it is written, then the hash of the board, each with its state) is claimed with a
+// compare and swap, the board and its moves are written, then the slot is marked ready. Several processes
+// can read and fill the same file at once : a slot being written is skipped by the others, and a board
+// solved by two of them is stored twice at worst. A slot left being written by a run that died is taken by
+// the next writer that probes it once no process has its pid (the runs sharing a file share their pids).
+// Boards or solutions too big for a slot, and boards past the last probe of a full table, are not cached.
+class SolutionCache {
+  public:
+    static const size_t SLOTS = 1 << 18; // 64 MB, the file is sparse until filled
+    static const size_t MAX_PROBES = 32;
+    static const size_t KEY_WORDS = 8;
+    static const size_t MOVE_BYTES = 176;
+    static const size_t MAX_MOVES = MOVE_BYTES * 4;
+
+    // the cache of that file, mapped the first time it is asked for
+    static SolutionCache& get(const std::string& path) {
+        static std::mutex lock;
+        static std::map<std::string, std::unique_ptr<SolutionCache> > caches;
+        std::lock_guard<std::mutex> guard(lock);
+        auto& cache = caches[path];
+
+        if (!cache)
+            cache.reset(new SolutionCache(path));
+        return *cache;
+    }
+
+    ~SolutionCache() {
+        munmap(_map, (SLOTS + 1) * sizeof(Slot));
+    }
+
+    bool find(const Board& key, Solution& solution) const {
+        uint64_t hash = key.hash() & ~STATE;
+
+        if (!fits(key))
+            return false;
+        for (size_t probe = 0; probe < MAX_PROBES; probe++) {
+            const Slot& slot = _slots[(hash + probe) & (SLOTS - 1)];
+            uint64_t control = slot.control.load(std::memory_order_acquire);
+            if (control == EMPTY)
+                return false;
+            if (control != (hash | READY) || !matches(slot, key))
+                continue;
+            solution = Solution();
+            for (size_t i = 0; i < slot.length; i++)
+                solution.push_back((GameState::Direction)((slot.moves[i / 4] >> (i % 4 * 2)) & 3));
+            return true;
+        }
+        return false;
+    }
+
+    void store(const Board& key, const Solution& solution) {
+        uint64_t hash = key.hash() & ~STATE;
+
+        if (!fits(key) || solution.size() > MAX_MOVES)
+            return;
+        for (size_t probe = 0; probe < MAX_PROBES; probe++) {
+            Slot& slot = _slots[(hash + probe) & (SLOTS - 1)];
+            uint64_t control = slot.control.load(std::memory_order_acquire);
+            if (control == (hash | READY) && matches(slot, key))
+                return;
+            if ((control != EMPTY && !abandoned(control))
+                || !slot.control.compare_exchange_strong(control, (uint64_t)getpid() << 2 | WRITING, std::memory_order_acquire))
+                continue;
+            slot.cells = key.cells();
+            slot.length = solution.size();
+            std::memcpy(slot.key, key.packed(), key.packedSize() * sizeof(uint64_t));
+            std::memset(slot.moves, 0, sizeof(slot.moves));
+            for (size_t i = 0; i < solution.size(); i++)
+                slot.moves[i / 4] |= solution[i] << (i % 4 * 2);
+            slot.control.store(hash | READY, std::memory_order_release);
+            return;
+        }
+    }
+
+  private:
+    static const uint64_t EMPTY = 0;
+    static const uint64_t WRITING = 1;
+    static const uint64_t READY = 2;
+    static const uint64_t STATE = 3; // low bits of the control word
+    static constexpr char MAGIC[8] = {'N', 'P', 'U', 'Z', 'C', 'A', 'C', '1'};
+
+    struct Slot {
+        std::atomic<uint64_t>   control;
+        uint16_t                cells;
+        uint16_t                length;
+        uint32_t                unused;
+        uint64_t                key[KEY_WORDS];
+        uint8_t                 moves[MOVE_BYTES]; // 2 bits per move
+    };
+    static_assert(sizeof(Slot) == 256, "cache slots are 256 bytes");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "the slots are shared between processes");
+
+    struct Header { // in the first slot
+        char        magic[8];
+        uint64_t    slots;
+        uint64_t    slotSize;
+    };
+
+    // the first run creates the file under an exclusive lock, the others check it was made for these slots
+    SolutionCache(const std::string& path) {
+        size_t total = (SLOTS + 1) * sizeof(Slot);
+        Header header;
+        struct stat st;
+        int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.slots = SLOTS;
+        header.slotSize = sizeof(Slot);
+        if (fd < 0)
+            throw std::runtime_error("Can't open cache " + path + " : " + std::strerror(errno));
+        flock(fd, LOCK_EX);
+        bool ok = fstat(fd, &st) == 0;
+        if (ok && st.st_size == 0)
+            ok = ftruncate(fd, total) == 0 && pwrite(fd, &header, sizeof(header), 0) == sizeof(header);
+        else if (ok) {
+            Header found;
+            ok = (size_t)st.st_size == total && pread(fd, &found, sizeof(found), 0) == sizeof(found)
+                && std::memcmp(&found, &header, sizeof(header)) == 0;
+        }
+        flock(fd, LOCK_UN);
+        _map = ok ? mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        close(fd);
+        if (_map == MAP_FAILED)
+            throw std::runtime_error("Can't map cache " + path + (ok ? "" : " : not a cache file of this version"));
+        _slots = static_cast<Slot *>(_map) + 1;
+    }
+
+    // written by a process that is gone
+    static bool abandoned(uint64_t control) {
+        return (control & STATE) == WRITING && kill((pid_t)(control >> 2), 0) != 0 && errno == ESRCH;
+    }
+
+    static bool fits(const Board& key) {
+        return key.packedSize() <= KEY_WORDS;
+    }
+
+    static bool matches(const Slot& slot, const Board& key) {
+        return slot.cells == key.cells() && std::memcmp(slot.key, key.packed(), key.packedSize() * sizeof(uint64_t)) == 0;
+    }
+
+    void    *_map;
+    Slot    *_slots;
+};
+
+constexpr char SolutionCache::MAGIC[8];
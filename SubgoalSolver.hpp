@@ -0,0 +1,291 @@
+#pragma once
+
+#include "GameState.hpp"
+#include "Generators.hpp"
+#include "Deadline.hpp"
+#include "IDAStar.hpp"
+#include <vector>
+#include <array>
+#include <stdexcept>
+
+// Sub-goal solver for the large boards, not optimal : the outer ring of the snail is placed one side at a
+// time, the board shrinks to the rectangle left, down to the 3x3 in its middle which is solved by IDA*.
+// Each tile of a side is pushed to its box one step at a time, the empty box going around it without
+// moving the tiles already placed. The last two tiles of a side can't be placed that way : the second
+// to last is parked in the corner, then both are swapped in by a search on the 3x3 window at the end of
+// the side, where the other tiles are alike. The memory is a few copies of the board.
+class SubgoalSolver {
+  public:
+    SubgoalSolver(const GameState& initial, const GameState& solution):
+        _size(initial.size()),
+        _board(_size * _size),
+        _where(_size * _size),
+        _goal(_size * _size),
+        _fixed(_size * _size, false),
+        _seen(_size * _size, 0),
+        _from(_size * _size),
+        _stamp(0),
+        _total_states(0),
+        _max_ressource(COPIES * _size * _size)
+    {
+        for (int y = 0; y < (int)_size; y++)
+            for (int x = 0; x < (int)_size; x++) {
+                _board[index(GameState::Point(x, y))] = initial[GameState::Point(x, y)];
+                _where[_board[index(GameState::Point(x, y))]] = index(GameState::Point(x, y));
+                _goal[index(GameState::Point(x, y))] = solution[GameState::Point(x, y)];
+            }
+        _empty = point(_where[0]);
+    }
+
+    Solution solve() {
+        int left = 0, top = 0, right = _size - 1, bottom = _size - 1;
+
+        if (_board == _goal)
+            return _moves;
+        for (size_t side = 0; right - left >= 3 || bottom - top >= 3; side = (side + 1) % 4) {
+            const GameState::Point corners[4] = {{left, top}, {right, top}, {right, bottom}, {left, bottom}};
+            size_t length = side % 2 ? bottom - top + 1 : right - left + 1;
+            line(corners[side], GameState::directions[side].second, GameState::directions[(side + 1) % 4].second, length);
+            switch (side) { // the rectangle left inside, the next side starts where this one ended
+                case GameState::RIGHT:  top++;      break;
+                case GameState::DOWN:   right--;    break;
+                case GameState::LEFT:   bottom--;   break;
+                case GameState::UP:     left++;     break;
+            }
+        }
+        finish(GameState::Point(left, top), right - left + 1);
+        return _moves;
+    }
+
+    size_t totalStates() const {
+        return _total_states;
+    }
+
+    size_t maxRessource() const {
+        return _max_ressource;
+    }
+
+  private:
+    static const size_t WINDOW = 8; // boxes of the window of the last two tiles of a side
+    static const size_t COPIES = 6; // of the board : _board, _where, _goal, _fixed, _seen and _from
+
+    // places the tiles of a side, from start along step, with the rest of the rectangle towards inward,
+    // which is at least 3 boxes deep
+    void line(const GameState::Point& start, const GameState::Point& step, const GameState::Point& inward, size_t length) {
+        auto box = [&](size_t along, size_t depth) { return start + step * along + inward * depth; };
+
+        for (size_t i = 0; i + 2 < length; i++) {
+            moveTile(_goal[index(box(i, 0))], box(i, 0));
+            _fixed[index(box(i, 0))] = true;
+        }
+        int first = _goal[index(box(length - 2, 0))];
+        int second = _goal[index(box(length - 1, 0))];
+        moveTile(first, box(length - 1, 0));
+        std::array<GameState::Point, WINDOW> window = {{ box(length - 2, 0), box(length - 1, 0), box(length - 3, 1),
+            box(length - 2, 1), box(length - 1, 1), box(length - 3, 2), box(length - 2, 2), box(length - 1, 2) }};
+        if (std::find(window.begin(), window.end(), point(_where[second])) == window.end()) {
+            _fixed[index(box(length - 1, 0))] = true; // first stays in the corner
+            moveTile(second, box(length - 2, 2));
+            _fixed[index(box(length - 1, 0))] = false;
+        }
+        swapIn(window, first, second);
+        _fixed[index(box(length - 2, 0))] = true;
+        _fixed[index(box(length - 1, 0))] = true;
+    }
+
+    // pushes the tile towards target one box at a time, by moving the empty box in front of it
+    void moveTile(int value, const GameState::Point& target) {
+        GameState::Point tile = point(_where[value]);
+
+        while (tile != target) {
+            bool moved = false;
+            for (auto& move : GameState::directions) {
+                GameState::Point next = tile + move.second;
+                if (next.distance(target) > tile.distance(target) || !free(next))
+                    continue;
+                _fixed[index(tile)] = true;
+                bool reached = moveEmpty(next);
+                _fixed[index(tile)] = false;
+                if (reached) {
+                    play(GameState::opposite(move.first));
+                    tile = next;
+                    moved = true;
+                    break;
+                }
+            }
+            if (!moved)
+                throw std::logic_error("Sub-goal solver : a tile can't be moved");
+        }
+    }
+
+    // moves the empty box to target without going through the fixed boxes, false if they wall it off
+    bool moveEmpty(const GameState::Point& target) {
+        for (int aside = -1; aside < 4; aside++) { // along two sides of a rectangle, or one step aside first
+            GameState::Point from = aside < 0 ? _empty : _empty + GameState::directions[aside].second;
+            for (bool horizontal_first : {true, false})
+                if (free(from) && straight(from, target, horizontal_first, false)) {
+                    if (aside >= 0)
+                        play((GameState::Direction)aside);
+                    straight(from, target, horizontal_first, true);
+                    return true;
+                }
+        }
+        std::vector<int> queue(1, index(_empty));
+        _stamp++;
+        _seen[index(_empty)] = _stamp;
+        for (size_t i = 0; i < queue.size(); i++) {
+            GameState::Point current = point(queue[i]);
+            _total_states++;
+            Deadline::check(_total_states);
+            if (current == target) {
+                std::vector<GameState::Direction> path;
+                for (; current != _empty; current = current - GameState::directions[_from[index(current)]].second)
+                    path.push_back(_from[index(current)]);
+                for (auto move = path.rbegin(); move != path.rend(); ++move)
+                    play(*move);
+                if (COPIES * _size * _size + queue.size() > _max_ressource)
+                    _max_ressource = COPIES * _size * _size + queue.size();
+                return true;
+            }
+            for (auto& move : GameState::directions) {
+                GameState::Point next = current + move.second;
+                if (!free(next) || _seen[index(next)] == _stamp)
+                    continue;
+                _seen[index(next)] = _stamp;
+                _from[index(next)] = move.first;
+                queue.push_back(index(next));
+            }
+        }
+        return false;
+    }
+
+    // whether the boxes from from to target along one axis then the other are free, played if walk
+    bool straight(const GameState::Point& from, const GameState::Point& target, bool horizontal_first, bool walk) {
+        GameState::Direction first = target.x > from.x ? GameState::RIGHT : GameState::LEFT;
+        GameState::Direction second = target.y > from.y ? GameState::DOWN : GameState::UP;
+        size_t first_steps = std::abs(target.x - from.x);
+        size_t second_steps = std::abs(target.y - from.y);
+        GameState::Point current = from;
+
+        if (!horizontal_first) {
+            std::swap(first, second);
+            std::swap(first_steps, second_steps);
+        }
+        for (size_t i = 0; i < first_steps + second_steps; i++) {
+            if (walk)
+                play(i < first_steps ? first : second);
+            current += GameState::directions[i < first_steps ? first : second].second;
+            if (!free(current))
+                return false;
+        }
+        return true;
+    }
+
+    // brings first and second to the first two boxes of the window, all in it, by a breadth first search on
+    // the boxes of first, second and the empty one
+    void swapIn(const std::array<GameState::Point, WINDOW>& window, int first, int second) {
+        auto at = [&](const GameState::Point& p) { return std::find(window.begin(), window.end(), p) - window.begin(); };
+        auto state = [](size_t empty, size_t a, size_t b) { return (empty * WINDOW + a) * WINDOW + b; };
+        std::vector<int> parent(WINDOW * WINDOW * WINDOW, -1);
+        std::vector<size_t> queue;
+
+        _fixed[_where[first]] = _fixed[_where[second]] = true;
+        bool reached = false;
+        for (size_t i = 0; i < WINDOW && !reached; i++)
+            reached = free(window[i]) && moveEmpty(window[i]);
+        _fixed[_where[first]] = _fixed[_where[second]] = false;
+        if (!reached)
+            throw std::logic_error("Sub-goal solver : the window can't be reached");
+        size_t start = state(at(_empty), at(point(_where[first])), at(point(_where[second])));
+        size_t end = start;
+        parent[start] = start;
+        queue.push_back(start);
+        for (size_t i = 0; i < queue.size(); i++) {
+            size_t empty = queue[i] / (WINDOW * WINDOW), a = queue[i] / WINDOW % WINDOW, b = queue[i] % WINDOW;
+            if (a == 0 && b == 1) {
+                end = queue[i];
+                break;
+            }
+            for (size_t next = 0; next < WINDOW; next++) {
+                if (window[next].distance(window[empty]) != 1)
+                    continue;
+                size_t child = state(next, a == next ? empty : a, b == next ? empty : b);
+                if (parent[child] != -1)
+                    continue;
+                parent[child] = queue[i];
+                queue.push_back(child);
+            }
+        }
+        std::vector<size_t> path;
+        for (size_t current = end; current != start; current = parent[current])
+            path.push_back(current / (WINDOW * WINDOW));
+        for (auto empty = path.rbegin(); empty != path.rend(); ++empty)
+            for (auto& move : GameState::directions)
+                if (_empty + move.second == window[*empty]) {
+                    play(move.first);
+                    break;
+                }
+    }
+
+    // solves the square left in the middle with IDA*, its tiles numbered by their boxes in the solution
+    void finish(const GameState::Point& origin, size_t width) {
+        std::vector<int> label(_size * _size, 0);
+        Data tiles(width * width), goal(width * width);
+        heuristic_t manhattan;
+        int next = 0;
+
+        manhattan.full = &GameState::manhattan;
+        manhattan.update = &GameState::updateManhattan;
+        for (size_t i = 0; i < width * width; i++) {
+            int value = _goal[index(origin + GameState::Point(i % width, i / width))];
+            label[value] = value ? ++next : 0;
+        }
+        for (size_t i = 0; i < width * width; i++) {
+            GameState::Point p = origin + GameState::Point(i % width, i / width);
+            tiles[i] = label[_board[index(p)]];
+            goal[i] = label[_goal[index(p)]];
+        }
+        GameState initial(tiles, width), solution(goal, width);
+        IDAStar ida(initial, solution, manhattan);
+        for (auto move : ida.solve())
+            play(move);
+        _total_states += ida.totalStates();
+    }
+
+    void play(GameState::Direction move) {
+        GameState::Point next = _empty + GameState::directions[move].second;
+        int value = _board[index(next)];
+
+        _board[index(_empty)] = value;
+        _where[value] = index(_empty);
+        _board[index(next)] = 0;
+        _where[0] = index(next);
+        _empty = next;
+        _moves.push_back(move);
+    }
+
+    bool free(const GameState::Point& p) const {
+        return p.in_bounds(_size) && !_fixed[index(p)];
+    }
+
+    int index(const GameState::Point& p) const {
+        return p.y * _size + p.x;
+    }
+
+    GameState::Point point(int index) const {
+        return GameState::Point(index % _size, index / _size);
+    }
+
+    size_t                              _size;
+    std::vector<int>                    _board;
+    std::vector<int>                    _where; // box of each tile
+    std::vector<int>                    _goal;
+    std::vector<bool>                   _fixed; // boxes placed, and the tile being moved
+    std::vector<uint32_t>               _seen; // stamp of the last search that reached each box
+    std::vector<GameState::Direction>   _from; // move that reached it
+    uint32_t                            _stamp;
+    GameState::Point                    _empty;
+    Solution                            _moves;
+    size_t                              _total_states;
+    size_t                              _max_ressource;
+};
@@ -0,0 +1,242 @@
+#pragma once
+
+#include "GameState.hpp"
+#include "LinearConflict.hpp"
+#include <vector>
+#include <string>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+#include <cstdint>
+
+// Walking distance heuristic.
+// A board is summarized by a matrix counting, for each row, how many of its tiles belong to each row of
+// the snail solution, and by the row of the empty box. A vertical move takes one tile from the row next
+// to the empty box into its row, so a breadth first search from the solution's matrix gives the number of
+// vertical moves needed for each matrix. The same is done with columns and the two are added.
+// Matrices are coded on 3 bits per count while the tables are built, the last count of each line is
+// implied by the line's size, the line of the empty box is in the top bits. Each one then gets an index,
+// in the order of the search, and the distance and the matrix after each move are read by index.
+// The indexes of the rows and of the columns of a state are its heuristic keys, with its linear conflict
+// for the walking conflict : the keys of a child are read from the ones of its parent.
+class WalkingDistance {
+  public:
+    static const size_t MAX_SIZE = 4; // above, the number of matrices explodes (tens of millions on a 5x5)
+
+    WalkingDistance(const std::vector<int>& solution) :
+        _size(std::sqrt(solution.size())),
+        _goalRow(solution.size()),
+        _goalColumn(solution.size())
+    {
+        size_t blank = 0;
+
+        if (_size > MAX_SIZE)
+            throw std::invalid_argument("Invalid Argument: Walking distance is only available up to "
+                + std::to_string(MAX_SIZE) + "x" + std::to_string(MAX_SIZE));
+        for (size_t i = 0; i < solution.size(); i++) {
+            _goalRow[solution[i]] = i / _size;
+            _goalColumn[solution[i]] = i % _size;
+            if (solution[i] == 0)
+                blank = i;
+        }
+        build(_rows, blank / _size);
+        build(_columns, blank % _size);
+    }
+
+    static void load(const std::vector<int>& solution) {
+        size_t size = std::sqrt(solution.size());
+        if (size <= MAX_SIZE && _tables[size] != nullptr)
+            return ;
+        WalkingDistance *tables = new WalkingDistance(solution);
+        _tables[size] = tables;
+    }
+
+    static size_t walkingDistance(const GameState &lhs, const GameState &) {
+        const WalkingDistance &wd = get(lhs.size());
+        return wd.distance(wd.keys(lhs));
+    }
+
+    // only the table of the lines the tile moves across changes
+    static int updateWalkingDistance(GameState &lhs, const GameState &, const GameState::Point &neighbor) {
+        const WalkingDistance &wd = get(lhs.size());
+        uint64_t parent = wd.keys(lhs);
+        uint64_t child = wd.child(lhs, parent, neighbor);
+
+        lhs.setHeuristicKeys(child);
+        return (int)wd.distance(child) - (int)wd.distance(parent);
+    }
+
+    // max of the walking distance and of the linear conflict, both admissible
+    static size_t walkingConflict(const GameState &lhs, const GameState &rhs) {
+        const WalkingDistance &wd = get(lhs.size());
+        return std::max(wd.distance(wd.keys(lhs)), LinearConflict::linearConflict(lhs, rhs));
+    }
+
+    static int updateWalkingConflict(GameState &lhs, const GameState &rhs, const GameState::Point &neighbor) {
+        const WalkingDistance &wd = get(lhs.size());
+        uint64_t parent = wd.keys(lhs);
+        size_t conflict = parent >> CONFLICT;
+
+        if (conflict == NO_CONFLICT)
+            conflict = LinearConflict::linearConflict(lhs, rhs);
+        size_t next = conflict + LinearConflict::updateLinearConflict(lhs, rhs, neighbor);
+        uint64_t child = (wd.child(lhs, parent, neighbor) & ~((uint64_t)NO_CONFLICT << CONFLICT)) | (uint64_t)next << CONFLICT;
+
+        lhs.setHeuristicKeys(child);
+        return (int)std::max(wd.distance(child), next) - (int)std::max(wd.distance(parent), conflict);
+    }
+
+  private:
+    static const uint16_t NONE = 0xffff; // index of no matrix
+    static const size_t COLUMNS = 16; // bit of the column index in the keys, the row index is at 0
+    static const size_t CONFLICT = 32; // and of the linear conflict
+    static const size_t NO_CONFLICT = 0xffff;
+
+    struct Table {
+        std::vector<uint8_t>                    distance; // by index
+        std::vector<uint16_t>                   next; // by index, side of the tile (1 if after the empty box's line) and goal line of the tile
+        std::unordered_map<uint64_t, uint16_t>  index; // of each code, to key a state without keys
+
+        uint16_t move(uint16_t index, size_t from, size_t to, size_t goal, size_t size) const {
+            return next[(index * 2 + (from > to)) * size + goal];
+        }
+    };
+
+    // keys of the state, read from the whole board if it has none
+    uint64_t keys(const GameState &state) const {
+        uint64_t keys = state.getHeuristicKeys();
+
+        if (keys != GameState::NO_KEYS)
+            return keys;
+        return _rows.index.at(rowKey(state)) | (uint64_t)_columns.index.at(columnKey(state)) << COLUMNS | (uint64_t)NO_CONFLICT << CONFLICT;
+    }
+
+    // keys once the tile of neighbor has moved into the empty box, the linear conflict is left as is
+    uint64_t child(const GameState &state, uint64_t parent, const GameState::Point &neighbor) const {
+        size_t tile = state[neighbor];
+        const GameState::Point &zero = state.zero();
+
+        if (neighbor.x == zero.x) // vertical move, tile goes from the neighbor's row to the empty box's row
+            return (parent & ~(uint64_t)NONE) | _rows.move(parent & NONE, neighbor.y, zero.y, _goalRow[tile], _size);
+        uint16_t columns = _columns.move(parent >> COLUMNS & NONE, neighbor.x, zero.x, _goalColumn[tile], _size);
+        return (parent & ~((uint64_t)NONE << COLUMNS)) | (uint64_t)columns << COLUMNS;
+    }
+
+    size_t distance(uint64_t keys) const {
+        return _rows.distance[keys & NONE] + _columns.distance[keys >> COLUMNS & NONE];
+    }
+
+    static const WalkingDistance& get(size_t size) {
+        if (size > MAX_SIZE || _tables[size] == nullptr)
+            throw std::invalid_argument("No walking distance table loaded for this size");
+        return *_tables[size];
+    }
+
+    size_t shift(size_t line, size_t goal) const {
+        return 3 * (line * (_size - 1) + goal);
+    }
+
+    uint64_t blankKey(size_t line) const {
+        return (uint64_t)line << 61;
+    }
+
+    size_t blankLine(uint64_t key) const {
+        return key >> 61;
+    }
+
+    size_t count(uint64_t key, size_t line, size_t goal) const {
+        if (goal < _size - 1)
+            return (key >> shift(line, goal)) & 7;
+        size_t total = _size - (blankLine(key) == line);
+        for (size_t g = 0; g < _size - 1; g++)
+            total -= (key >> shift(line, g)) & 7;
+        return total;
+    }
+
+    // a tile belonging to goal goes from line from to line to, where the empty box was
+    uint64_t moveTile(uint64_t key, size_t from, size_t to, size_t goal) const {
+        if (goal < _size - 1)
+            key = key - ((uint64_t)1 << shift(from, goal)) + ((uint64_t)1 << shift(to, goal));
+        return (key & ~blankKey(7)) | blankKey(from);
+    }
+
+    uint64_t rowKey(const GameState &state) const {
+        uint64_t key = blankKey(state.zero().y);
+        GameState::Point p;
+
+        for (p.y = 0; (size_t)p.y < _size; p.y++)
+            for (p.x = 0; (size_t)p.x < _size; p.x++) {
+                size_t goal = _goalRow[state[p]];
+                if (state[p] != 0 && goal < _size - 1)
+                    key += (uint64_t)1 << shift(p.y, goal);
+            }
+        return key;
+    }
+
+    uint64_t columnKey(const GameState &state) const {
+        uint64_t key = blankKey(state.zero().x);
+        GameState::Point p;
+
+        for (p.y = 0; (size_t)p.y < _size; p.y++)
+            for (p.x = 0; (size_t)p.x < _size; p.x++) {
+                size_t goal = _goalColumn[state[p]];
+                if (state[p] != 0 && goal < _size - 1)
+                    key += (uint64_t)1 << shift(p.x, goal);
+            }
+        return key;
+    }
+
+    // breadth first search from the solution, where each line only holds its own tiles, then the matrix
+    // after each move of each matrix found
+    void build(Table &table, size_t blank) {
+        std::vector<uint64_t> codes; // by index
+        uint64_t start = blankKey(blank);
+
+        for (size_t line = 0; line < _size - 1; line++)
+            start += (uint64_t)(_size - (line == blank)) << shift(line, line);
+        table.index[start] = 0;
+        table.distance.push_back(0);
+        codes.push_back(start);
+        for (size_t i = 0; i < codes.size(); i++) {
+            uint64_t key = codes[i];
+            size_t to = blankLine(key);
+            for (size_t from : {to - 1, to + 1}) {
+                if (from >= _size) // also catches to - 1 when to is 0
+                    continue;
+                for (size_t goal = 0; goal < _size; goal++) {
+                    if (count(key, from, goal) == 0)
+                        continue;
+                    uint64_t moved = moveTile(key, from, to, goal);
+                    if (table.index.insert(std::make_pair(moved, codes.size())).second) {
+                        table.distance.push_back(table.distance[i] + 1);
+                        codes.push_back(moved);
+                    }
+                }
+            }
+        }
+        if (codes.size() >= NONE)
+            throw std::logic_error("Walking distance : too many matrices to index on 16 bits");
+        table.next.assign(codes.size() * 2 * _size, NONE);
+        for (size_t i = 0; i < codes.size(); i++) {
+            size_t to = blankLine(codes[i]);
+            for (size_t from : {to - 1, to + 1})
+                for (size_t goal = 0; from < _size && goal < _size; goal++)
+                    if (count(codes[i], from, goal) != 0)
+                        table.next[(i * 2 + (from > to)) * _size + goal] = table.index.at(moveTile(codes[i], from, to, goal));
+        }
+    }
+
+    size_t              _size;
+    std::vector<size_t> _goalRow;
+    std::vector<size_t> _goalColumn;
+    Table               _rows;
+    Table               _columns;
+
+    static WalkingDistance *_tables[MAX_SIZE + 1];
+};
+
+WalkingDistance *WalkingDistance::_tables[WalkingDistance::MAX_SIZE + 1] = {};
+const uint16_t WalkingDistance::NONE;
+const size_t WalkingDistance::COLUMNS;
+const size_t WalkingDistance::CONFLICT;
+const size_t WalkingDistance::NO_CONFLICT;
@@ -0,0 +1,53 @@
+#!/bin/sh
+# Solves the benchmark corpus and the solvable test maps with every heuristic and engine,
+# and prints one csv line per run. Runs are limited to BENCH_TIMEOUT seconds (10 by default),
+# BENCH_HEURISTICS and BENCH_ENGINES restrict them (same names as below).
+
+cd "$(dirname "$0")/.." || exit 1
+
+TIMEOUT=${BENCH_TIMEOUT:-10}
+HEURISTICS=${BENCH_HEURISTICS:-"none manhattan linear-conflict hamming pdb walking-distance walking-conflict"}
+ENGINES=${BENCH_ENGINES:-"astar ida bidirectional hda anytime frontier parallel-ida large partial"}
+MAPS=$(mktemp -d)
+trap 'rm -rf "$MAPS" "$MAPS.out"' EXIT
+
+i=0
+grep -v '^#' bench/corpus.txt | while read -r line; do
+    i=$((i + 1))
+    echo "$line" > "$MAPS/corpus-$i"
+done
+cp tests/*-solvable "$MAPS"
+
+# pattern databases are built once, outside of the measures
+for map in "$MAPS"/*; do
+    ./n_puzzle --pdb --stats=csv "$map" < /dev/null > /dev/null
+done
+
+echo "instance,heuristic,engine,status,moves,expanded,max_ressource,seconds,nodes_per_second,peak_rss_kb"
+for map in $(ls "$MAPS" | sort -V); do
+    for heuristic in $HEURISTICS; do
+        for engine in $ENGINES; do
+            options=""
+            [ "$heuristic" != none ] && options="--$heuristic"
+            case $engine in
+                ida) options="$options --ida" ;;
+                bidirectional) options="$options --bidirectional" ;;
+                hda) options="$options --jobs=4" ;;
+                anytime) options="$options --anytime" ;;
+                frontier) options="$options --frontier" ;;
+                parallel-ida) options="$options --ida --jobs=4" ;;
+                large) # always the manhattan distance, run once
+                    [ "$heuristic" != manhattan ] && continue
+                    options="--large" ;;
+                partial) options="$options --partial" ;;
+            esac
+            timeout "$TIMEOUT" ./n_puzzle $options --stats=csv "$MAPS/$map" < /dev/null > "$MAPS.out" 2> /dev/null
+            case $? in
+                0) status=ok; result=$(tail -n 1 "$MAPS.out") ;;
+                124) status=timeout; result=",,,,," ;;
+                *) status=error; result=",,,,," ;;
+            esac
+            echo "$map,$heuristic,$engine,$status,$result"
+        done
+    done
+done
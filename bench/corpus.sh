@@ -0,0 +1,22 @@
+#!/bin/sh
+# Writes the benchmark corpus, bench/corpus.txt, with the random maps of n_puzzle --count : random walks
+# from the snail goal, so all are solvable, from fixed seeds. The walks depend on the random distributions
+# of the standard library, the corpus was made with the libstdc++ of g++.
+
+cd "$(dirname "$0")/.." || exit 1
+
+# maps COUNT DIFFICULTY SIZE WHAT
+maps() {
+    echo "# $4 : ./n_puzzle --count=$1 --difficulty=$2 --seed=1 $3"
+    ./n_puzzle --count="$1" --difficulty="$2" --seed=1 "$3" || exit 1
+}
+
+{
+    echo "# Benchmark corpus, one puzzle per line : size then values (snail goal), written by bench/corpus.sh."
+    echo "# Kept as is so that results can be compared between commits."
+    maps 4 1000 3 "3x3, 18 to 24 moves"
+    maps 4 40 4 "4x4, 24 to 36 moves"
+    maps 4 300 4 "4x4, 50 to 54 moves"
+    maps 3 40 5 "5x5, 30 to 38 moves"
+    maps 3 80 5 "5x5, 52 to 58 moves"
+} > bench/corpus.txt
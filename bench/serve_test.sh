@@ -0,0 +1,78 @@
+#!/bin/sh
+# Checks the answers of --serve : on the standard input, then on a Unix socket with two clients at once
+# (python3 stands in for the real callers). Prints the failures and exits with their number.
+
+cd "$(dirname "$0")/.." || exit 1
+
+SOCKET=$(mktemp -u)
+OUT=$(mktemp)
+trap 'kill "$SERVER" 2> /dev/null; rm -f "$SOCKET" "$OUT"' EXIT
+failures=0
+
+# one line per puzzle : size then values
+line() {
+    grep -v '^#' "$1" | sed 's/#.*//' | tr -s ' \n' ' '
+}
+
+# expect NAME ANSWER PATTERN : ANSWER must match the extended regular expression PATTERN
+expect() {
+    if ! echo "$2" | grep -Eq "$3"; then
+        echo "$1 : got \"$2\", expected $3"
+        failures=$((failures + 1))
+    fi
+}
+
+# standard input : answers in the order of the requests, whatever the thread that solved them
+{
+    line tests/test4-solvable; echo
+    line tests/test3-solvable; echo
+    line tests/test3-unsolvable; echo
+    echo "# comment"
+    echo "3 1 2"
+    line tests/test3-solvable; echo
+} | ./n_puzzle --linear-conflict --jobs=2 --serve=- > "$OUT" 2> /dev/null
+expect "stdin exit status" "$?" "^0$"
+expect "stdin answers" "$(wc -l < "$OUT" | tr -d ' ')" "^5$"
+expect "stdin 4x4" "$(sed -n 1p "$OUT")" "^54 [0-9]+ [0-9]+ [0-9.e-]+ [RDLU]{54}$"
+expect "stdin 3x3" "$(sed -n 2p "$OUT")" "^20 [0-9]+ [0-9]+ [0-9.e-]+ [RDLU]{20}$"
+expect "stdin unsolvable" "$(sed -n 3p "$OUT")" "^unsolvable$"
+expect "stdin bad request" "$(sed -n 4p "$OUT")" "^error "
+expect "stdin 3x3 again" "$(sed -n 5p "$OUT")" "^20 "
+
+# time limit of a request
+answer=$(line tests/test4-solvable | ./n_puzzle --jobs=1 --timeout=0.01 --serve=- 2> /dev/null)
+expect "timeout" "$answer" "^timeout$"
+
+# Unix socket : two clients at once, each gets its own answers
+./n_puzzle --linear-conflict --jobs=2 --serve="$SOCKET" 2> /dev/null &
+SERVER=$!
+answers=$(python3 - "$SOCKET" "$(line tests/test3-solvable)" "$(line tests/test4-solvable)" <<'EOF'
+import socket, sys, threading, time
+
+def client(request, answers, i):
+    s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    for _ in range(50):
+        try:
+            s.connect(sys.argv[1])
+            break
+        except OSError:
+            time.sleep(0.1)
+    s.sendall(((request + "\n") * 2).encode())
+    s.shutdown(socket.SHUT_WR)
+    answers[i] = s.makefile().read().splitlines()
+
+answers = [None, None]
+threads = [threading.Thread(target=client, args=(sys.argv[2 + i], answers, i)) for i in range(2)]
+for t in threads:
+    t.start()
+for t in threads:
+    t.join()
+for lines in answers:
+    print(" ".join(line.split()[0] for line in lines or []))
+EOF
+)
+expect "socket clients" "$answers" "^20 20
+54 54$"
+
+[ "$failures" -eq 0 ] && echo "serve : ok"
+exit "$failures"
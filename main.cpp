@@ -1,12 +1,18 @@
 #include "Generators.hpp"
 #include "Puzzle.hpp"
+#include "Batch.hpp"
+#include "Server.hpp"
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <chrono>
 
 void print_usage() {
     std::cout << "\
 Usage : ./n_puzzle [OPTION]... [ARG] \n\
+  or :  ./n_puzzle [OPTION]... --batch=FILE\n\
+  or :  ./n_puzzle [OPTION]... --serve=SOCKET\n\
+  or :  ./n_puzzle --count=N [--difficulty=K] [--seed=N] SIZE\n\
 Implementation of the A* algorithm to solve N-puzzles\n\
 \n\
 ARG is either a size or a path to a map\n\
@@ -15,7 +21,45 @@ Options:\n\
   -m, --manhattan-distance\tmanhattan distance heuristic\n\
   -l, --linear-conflict\t\tmanhattan distance + linear conflict heuristic\n\
   -h, --hamming\t\t\thamming disntance heuristic\n\
+  -p, --pdb[=FILE]\t\tadditive pattern database heuristic, built once and saved to FILE\n\
+      --pdb-groups=SIZES\tsizes of the pattern database groups (default 8 on 3x3, 6-6-3 on 4x4, 5-5-5-5-4 on 5x5)\n\
+  -d, --walking-distance\twalking distance heuristic (up to 4x4)\n\
+  -c, --walking-conflict\tmax of walking distance and manhattan distance + linear conflict\n\
   -g, --greedy\t\t\tgreedy search (Not guaranteed to find the shortest solution)\n\
+  -w, --weight=W\t\tweighted A*, the solution is at most W times longer than the shortest\n\
+  -a, --anytime\t\t\tanytime A* : prints a first solution found with weight W (3 by default),\n\
+\t\t\t\tthen shorter ones as the weight is lowered down to 1\n\
+  -i, --ida\t\t\titerative deepening A*, only keeps the current path in memory\n\
+  -b, --bidirectional		bidirectional A* meeting in the middle, searching from both ends\n\
+  -f, --frontier\t\tfrontier A* : only keeps the open states, the solution is rebuilt\n\
+\t\t\t\tby searching again towards its middle state\n\
+      --partial\t\tpartial expansion A* : only stores the children whose f is the one of their\n\
+\t\t\t\tparent, which is queued again for the others\n\
+      --large\t\t\tplaces the outer ring tile by tile then solves the board left inside, for the\n\
+\t\t\t\tlarge boards : fast, linear memory, but the solution is not the shortest\n\
+  -j, --jobs=N\t\t\thash distributed A* on N threads (IDA* with -i), or N puzzles solved at once\n\
+\t\t\t\twith --batch or --serve\n\
+      --memory=MB\t\tmemory of the closed lists, taken at once, the search stops if it is not enough\n\
+      --cache=FILE\t\tfile of the shortest solutions already found, read before searching and\n\
+\t\t\t\tfilled after, can be shared by several runs at once\n\
+      --count=N\t\t\tprints N solvable random maps of size SIZE instead of solving one,\n\
+\t\t\t\tone per line (size then values)\n\
+      --difficulty=K\t\tmakes them with a random walk of K moves from the solution\n\
+\t\t\t\tinstead of a shuffle\n\
+      --seed=N\t\tseed of the random map, for reproducible runs\n\
+      --no-animate\t\tprints every state of the solution at once instead of one per line read\n\
+      --final-only\t\tprints the final state only\n\
+      --moves-only\t\tprints the moves only, as the letters of the empty box moves (RDLU)\n\
+      --stats=FORMAT\t\tprints the search statistics instead of playing the solution, FORMAT is\n\
+\t\t\t\tcsv (moves, total states, max ressource, seconds, states per second, peak memory in kB)\n\
+\t\t\t\tor json (the same and the details of A*)\n\
+      --batch=FILE\t\tsolves all the puzzles of FILE (- for the standard input), written as maps or\n\
+\t\t\t\ton one line each (size then values), and prints one line per puzzle :\n\
+\t\t\t\tnumber, moves count, total states, max ressource, moves (RDLU)\n\
+      --serve=SOCKET\t\tkeeps running and solves the puzzles sent on the Unix SOCKET (- for the\n\
+\t\t\t\tstandard input), one per line (size then values), answering each with\n\
+\t\t\t\tmoves count, total states, max ressource, seconds, moves (RDLU)\n\
+      --timeout=SECONDS\t\ttime limit of each search, answered \"timeout\" with --serve\n\
 \n\
 No option will run the A* with uniform cost search\n\
 \n\
@@ -30,21 +74,44 @@ int main(int argc, char *argv[])
         print_usage();
         return 1;
     }
-    std::srand(time(NULL));
     try {
         Generators gen;
-        Puzzle puzzle(gen.setHeuristic(argc, argv), gen.initMap(argv[argc - 1]), gen.generateSolution());
+        heuristic_t heuristic = gen.setHeuristic(argc, argv);
+        if (!heuristic.batch.empty()) {
+            Batch(heuristic).run();
+            return 0;
+        }
+        if (heuristic.count) {
+            gen.generate(argv[argc - 1], heuristic.count, heuristic.difficulty);
+            return 0;
+        }
+        if (!heuristic.serve.empty()) {
+            Server(heuristic).run();
+            return 0;
+        }
+        Data data = gen.initMap(argv[argc - 1]); // must run before generateSolution(), which needs the parsed size
+        Data goal = gen.generateSolution();
+        heuristic.loadTables(goal);
+        Puzzle puzzle(heuristic, data, goal);
+        auto start = std::chrono::steady_clock::now();
+        Deadline::set(heuristic.timeout);
         auto solution = puzzle.solve();
-        if (solution.size())
+        std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+        if (!heuristic.stats.empty())
+            puzzle.printStats(solution, seconds.count());
+        else if (solution.size())
             puzzle.play(solution);
-    } catch (Generators::ParsingException e) {
+    } catch (Generators::ParsingException &e) {
         std::cerr << "Parsing error : " << e.what() << std::endl;
         return 1;
-    } catch (std::invalid_argument e) {
+    } catch (std::invalid_argument &e) {
         std::cerr << e.what() << std::endl;
         print_usage();
         return 1;
-    } catch (std::exception e) {
+    } catch (std::runtime_error &e) {
+        std::cerr << "Error : " << e.what() << std::endl;
+        return 1;
+    } catch (std::exception &e) {
         std::cerr << "Error : " << e.what() << std::endl;
         throw;
         return 1;